@@ -7,6 +7,7 @@
 #include "robo7_msgs/allObjects.h"
 #include "robo7_msgs/the_robot_position.h"
 #include "robo7_srvs/distanceTo.h"
+#include "robo7_srvs/distanceToMany.h"
 #include "robo7_srvs/IsGridOccupied.h"
 #include "robo7_srvs/GoTo.h"
 #include "robo7_srvs/PickupAt.h"
@@ -23,6 +24,7 @@ public:
 	ros::Publisher all_obj_pub;
 	ros::Publisher espeak_pub;
 	ros::ServiceClient distance_srv;
+	ros::ServiceClient distances_srv;
 	ros::ServiceClient occupancy_srv;
 	ros::ServiceClient go_to_srv;
 	ros::ServiceClient pickup_at_srv;
@@ -55,6 +57,7 @@ public:
 
 		// Services
 		distance_srv = n.serviceClient<robo7_srvs::distanceTo>("/distance_grid/distance");
+		distances_srv = n.serviceClient<robo7_srvs::distanceToMany>("/distance_grid/distances");
 		occupancy_srv = n.serviceClient<robo7_srvs::IsGridOccupied>("/occupancy_grid/is_occupied");
 		go_to_srv = n.serviceClient<robo7_srvs::GoTo>("/kinematics/go_to");
 		pickup_at_srv = n.serviceClient<robo7_srvs::PickupAt>("/gate_controller/pickup_at");
@@ -227,6 +230,34 @@ public:
 	}
 
 
+	// Distance from the robot and occupancy for many positions in one request
+	bool getPoseCosts(const std::vector<float> & xs, const std::vector<float> & ys, std::vector<int> & distances, std::vector<float> & occupancies){
+		ros::spinOnce();
+
+		robo7_srvs::distanceToMany::Request srv_req;
+		robo7_srvs::distanceToMany::Response srv_resp;
+
+		if (!robot_position_set){
+			ROS_WARN("Brain: Trying to evaluate distance to objects without knowing the robot position");
+			return false;
+		}
+
+		srv_req.x_from = robo_pos.linear.x;
+		srv_req.y_from = robo_pos.linear.y;
+		srv_req.x_to = xs;
+		srv_req.y_to = ys;
+
+		if (!distances_srv.call(srv_req, srv_resp) || srv_resp.distances.size() != xs.size()){
+			return false;
+		}
+
+		distances.assign(srv_resp.distances.begin(), srv_resp.distances.end());
+		occupancies = srv_resp.occupancies;
+
+		return true;
+	}
+
+
 	float getOccupancy(float x, float y){
 		robo7_srvs::IsGridOccupied::Request srv_req;
 		robo7_srvs::IsGridOccupied::Response srv_resp;
@@ -296,14 +327,37 @@ public:
 		float test_lowest_occu_y;
 		float test_lowest_occu_ang_z;
 
-		// returns a pose that is possible to travel to, given the destination
+		std::vector<float> test_alps, test_xs, test_ys, occupancies;
+		std::vector<int> distances;
+
 		for (float alp = 0 ; alp < 2*pi ; alp = alp+(pi/8)){
+			test_alps.push_back(alp);
+			test_xs.push_back(x_dest + (robot_pose_dist * cos(alp)));
+			test_ys.push_back(y_dest + (robot_pose_dist * sin(alp)));
+		}
+
+		// all the poses in one request, one call per pose if the server is too old
+		if (!getPoseCosts(test_xs, test_ys, distances, occupancies)){
+			ROS_WARN("Brain: Batched distance request failed, testing the poses one by one");
+
+			distances.clear();
+			occupancies.clear();
+
+			for (int k = 0 ; k < test_xs.size() ; k++){
+				occupancies.push_back(getOccupancy(test_xs[k], test_ys[k]));
+				distances.push_back(getDistance(test_xs[k], test_ys[k], true));
+			}
+		}
+
+		// returns a pose that is possible to travel to, given the destination
+		for (int k = 0 ; k < test_xs.size() ; k++){
 
-			float test_x = x_dest + (robot_pose_dist * cos(alp));
-			float test_y = y_dest + (robot_pose_dist * sin(alp));
+			float alp = test_alps[k];
+			float test_x = test_xs[k];
+			float test_y = test_ys[k];
 
-			float new_occupancy = getOccupancy(test_x, test_y);
-			int new_distance = getDistance(test_x, test_y, true);
+			float new_occupancy = occupancies[k];
+			int new_distance = distances[k];
 
 			//ROS_INFO("Brain:getDestPose testing: x:%f, y:%f and got got occupancy: %f", test_x, test_y, new_occupancy);
 			//ROS_INFO("Brain: Occ: %f, Dist: %d", (float)new_occupancy, (int)new_distance);
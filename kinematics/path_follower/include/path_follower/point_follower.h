@@ -0,0 +1,145 @@
+#ifndef PATH_FOLLOWER_POINT_FOLLOWER_H
+#define PATH_FOLLOWER_POINT_FOLLOWER_H
+
+#include <math.h>
+#include <vector>
+
+// The control law of path_follower_v2 in point following mode: head for the
+// next point of the path with a saturated P controller on the angle, and
+// only drive forward when the point is roughly ahead. Free of ROS so the
+// simulator runs the same follower.
+
+class PointFollower
+{
+public:
+  PointFollower()
+  {
+    //Values of kinematics.launch
+    dest_threshold = 0.05;
+    dest_to_next_point = 0.1;
+    a_P = 2;
+    desire_angular_sat = 2;
+    angle_ref_max = 0.4;
+    aver_lin_vel = 0.15;
+    index_point_following = 0;
+  }
+
+  //Starts over on a new path
+  void set_path( const std::vector<float> &path_x , const std::vector<float> &path_y )
+  {
+    points_x = path_x;
+    points_y = path_y;
+    index_point_following = 0;
+  }
+
+  int number_of_points() const
+  {
+    return static_cast<int>(points_x.size());
+  }
+
+  //Choose the point to follow from the robot position
+  int point_to_follow( float x_r , float y_r )
+  {
+    while((index_point_following < number_of_points() - 1)
+            &&(distance_to_point( x_r , y_r , index_point_following ) < dest_to_next_point))
+    {
+      index_point_following++;
+    }
+
+    return index_point_following;
+  }
+
+  //Velocities towards the point to follow, true once the end of the path is reached
+  bool update( float x_r , float y_r , float a_r , float &linear_vel , float &angular_vel )
+  {
+    float x = (points_x[index_point_following] - x_r) * cos(a_r) + (points_y[index_point_following] - y_r) * sin(a_r);
+    float y = - (points_x[index_point_following] - x_r) * sin(a_r) + (points_y[index_point_following] - y_r) * cos(a_r);
+    float diff_angle = findangle(x, y);
+
+    //Then update the linear speed
+    if(sgn(diff_angle)*diff_angle > angle_ref_max)
+    {
+      linear_vel = 0;
+      angular_vel = P_update( diff_angle );
+      angle_ref_max = pi()/8;
+    }
+    else
+    {
+      linear_vel = aver_lin_vel;
+      angular_vel = P_update( diff_angle );
+      angle_ref_max = pi()/6;
+    }
+
+    //Then check if the path came to an end
+    if((index_point_following == number_of_points() - 1)
+        &&(distance_to_point( x_r , y_r , index_point_following ) < dest_threshold))
+    {
+      linear_vel = 0;
+      angular_vel = 0;
+      return true;
+    }
+
+    return false;
+  }
+
+  static float findangle(float x, float y)
+  {
+    if(x==0)
+    {
+      return pi()*sgn(y);
+    }
+    else if((x<0)&&(y>0))
+    {
+      return atan(y/x) + pi();
+    }
+    else if ((x<0)&&(y<0))
+    {
+      return atan(y/x) - pi();
+    }
+    else
+    {
+      return atan(y/x);
+    }
+  }
+
+  //Controllers values
+  float a_P;
+  float desire_angular_sat;
+  float angle_ref_max;
+  float aver_lin_vel;
+  float dest_threshold, dest_to_next_point;
+
+private:
+  //Same rounding as path_follower_v2 always had
+  static float pi()
+  {
+    return 3.14;
+  }
+
+  static int sgn(float v)
+  {
+    if (v < 0) return -1;
+    else if (v > 0) return 1;
+    else return 0;
+  }
+
+  float distance_to_point( float x_r , float y_r , int index )
+  {
+    return sqrt(pow(x_r-points_x[index],2)+pow(y_r-points_y[index],2));
+  }
+
+  float P_update(float difference_angle)
+  {
+    float angular_vel = (a_P * difference_angle);
+
+    if(angular_vel > desire_angular_sat) { angular_vel = desire_angular_sat; }
+    else if(angular_vel < -desire_angular_sat) { angular_vel = -desire_angular_sat; }
+
+    return angular_vel;
+  }
+
+  std::vector<float> points_x, points_y;
+  int index_point_following;
+};
+
+#endif
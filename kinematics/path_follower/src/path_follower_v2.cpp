@@ -14,8 +14,11 @@
 #include <robo7_srvs/PathFollower2.h>
 #include <robo7_srvs/PureRotation.h>
 #include <robo7_srvs/IsGridOccupied.h>
+#include <robo7_srvs/IsGridOccupiedBatch.h>
 #include <robo7_srvs/MoveStraight.h>
 #include <robo7_srvs/FilterOn.h>
+//Control law
+#include <path_follower/point_follower.h>
 
 float control_frequency = 10.0;
 float pi = 3.14;
@@ -27,17 +30,17 @@ public:
   ros::Subscriber robot_pose_sub, object_detection_sub;
   ros::Publisher desired_velocity_pub, trigger_classification_pub;
   ros::ServiceServer path_follower_server;
-  ros::ServiceClient pure_rotation_srv, is_cell_occupied_srv, move_straight_srv, classification_srv;
+  ros::ServiceClient pure_rotation_srv, is_cell_occupied_srv, are_cells_occupied_srv, move_straight_srv, classification_srv;
 
   path_follower_v2()
   {
     //Initialisation parameters
-    n.param<float>("/path_follower_v2/distance_to_destination_threshold", dest_threshold, 0.01);
-    n.param<float>("/path_follower_v2/distance_to_jump_to_next_point", dest_to_next_point, 0.05);
-    n.param<float>("/path_follower_v2/angle_P", a_P, 0.05);
-    n.param<float>("/path_follower_v2/angular_velocity_saturation", desire_angular_sat, 0.05);
-    n.param<float>("/path_follower_v2/angular_threshold_trust", angle_ref_max, pi/8);
-    n.param<float>("/path_follower_v2/aver_linear_speed", aver_lin_vel, 0.0);
+    n.param<float>("/path_follower_v2/distance_to_destination_threshold", follower.dest_threshold, 0.01);
+    n.param<float>("/path_follower_v2/distance_to_jump_to_next_point", follower.dest_to_next_point, 0.05);
+    n.param<float>("/path_follower_v2/angle_P", follower.a_P, 0.05);
+    n.param<float>("/path_follower_v2/angular_velocity_saturation", follower.desire_angular_sat, 0.05);
+    n.param<float>("/path_follower_v2/angular_threshold_trust", follower.angle_ref_max, pi/8);
+    n.param<float>("/path_follower_v2/aver_linear_speed", follower.aver_lin_vel, 0.0);
     n.param<float>("/path_follower_v2/discretization_length", discretize_length, 0.0);
     n.param<float>("/path_follower_v2/classification_time_standing_still", classification_time, 5.0);
     n.param<bool>("/path_follower_v2/following_point_mode", point_follower_mode, true);
@@ -51,6 +54,7 @@ public:
 
     pure_rotation_srv = n.serviceClient<robo7_srvs::PureRotation>("/kinematics/path_follower/pure_rotation");
     is_cell_occupied_srv = n.serviceClient<robo7_srvs::IsGridOccupied>("/occupancy_grid/is_occupied");
+    are_cells_occupied_srv = n.serviceClient<robo7_srvs::IsGridOccupiedBatch>("/occupancy_grid/is_occupied_batch");
     move_straight_srv = n.serviceClient<robo7_srvs::MoveStraight>("/kinematics/path_follower/straight_move");
     classification_srv = n.serviceClient<robo7_srvs::FilterOn>("/object_filter/activate");
 
@@ -103,7 +107,7 @@ public:
         float y1 = the_robot_pose.position.linear.y;
         float x2 = point_following.x;
         float y2 = point_following.y;
-        initial_angle = findangle( x1-x2 , y1-y2 );
+        initial_angle = PointFollower::findangle( x1-x2 , y1-y2 );
 
         //First align the robot with the path start (aka call service)
         robo7_srvs::PureRotation::Request req1;
@@ -114,6 +118,14 @@ public:
 
       geometry_msgs::Twist desire_vel;
 
+      std::vector<float> path_x, path_y;
+      for(int i=0; i<the_discretized_path.number; i++)
+      {
+        path_x.push_back(the_discretized_path.the_points[i].x);
+        path_y.push_back(the_discretized_path.the_points[i].y);
+      }
+      follower.set_path( path_x , path_y );
+
       ros::Rate loop_rate(100);
 
       //Then make it follow the path
@@ -122,10 +134,12 @@ public:
         //Extract the position with the subscriber
         ros::spinOnce();
 
-        float velocity_sign = 1;
+        float x_r = the_robot_pose.position.linear.x;
+        float y_r = the_robot_pose.position.linear.y;
+        float a_r = the_robot_pose.position.angular.z;
 
         //Choose the point to follow
-        index_point_following = point_to_follow( the_discretized_path , index_point_following );
+        index_point_following = follower.point_to_follow( x_r , y_r );
         point_following = the_discretized_path.the_points[index_point_following];
         // ROS_INFO("point to follow %d over %d", index_point_following, the_discretized_path.number);
 
@@ -172,32 +186,11 @@ public:
           trigger_classification_pub.publish( state_class );
         }
 
-        //Extract the angle difference out of this point to follow
-        diff_angle = compute_diff_angle( point_following );
-        // ROS_INFO("angle diff %lf", diff_angle);
-
-        //Then update the linear speed
-        if(sgn(diff_angle)*diff_angle > angle_ref_max)
-        {
-          desire_vel.linear.x = 0;
-          desire_vel.angular.z = P_update( diff_angle );
-          angle_ref_max = pi/8;
-        }
-        else
-        {
-          desire_vel.linear.x = velocity_sign * aver_lin_vel;
-          desire_vel.angular.z = P_update( diff_angle );
-          angle_ref_max = pi/6;
-        }
-
-        //Then check if the path came to an end
-        if((index_point_following == the_discretized_path.number-1)
-            &&(distance_to_point( the_discretized_path.the_points[index_point_following]) < dest_threshold))
-          {
-            path_ended = true;
-            desire_vel.linear.x = 0;
-            desire_vel.angular.z = 0;
-          }
+        //Then update the speeds towards it, and check if the path came to an end
+        float linear_vel, angular_vel;
+        path_ended = follower.update( x_r , y_r , a_r , linear_vel , angular_vel );
+        desire_vel.linear.x = linear_vel;
+        desire_vel.angular.z = angular_vel;
 
         //Then publish the speed
         desired_velocity_pub.publish( desire_vel );
@@ -220,14 +213,11 @@ private:
   robo7_msgs::the_robot_position the_robot_pose;
   robo7_msgs::detectedState the_objects_states;
 
-  //Controllers values
-  float a_P;
-  float desire_angular_sat;
-  float angle_ref_max, diff_angle, initial_angle;
-  float aver_lin_vel;
+  //Controller
+  PointFollower follower;
+  float initial_angle;
 
   //Which path follower we choose
-  float dest_threshold, dest_to_next_point;
   float discretize_length;
   bool point_follower_mode;
   bool mapping_mode;
@@ -236,78 +226,6 @@ private:
   double time_prev;
   float classification_time;
 
-  int point_to_follow( robo7_msgs::wallPoint discretized_path_msg, int current_index)
-  {
-    int the_new_index = current_index;
-
-    if(distance_to_point(discretized_path_msg.the_points[the_new_index]) < dest_to_next_point)
-    {
-      while((distance_to_point(discretized_path_msg.the_points[the_new_index]) < dest_to_next_point)
-              &&(the_new_index < discretized_path_msg.number - 1))
-        {
-          the_new_index++;
-        }
-    }
-
-    return the_new_index;
-  }
-
-  float distance_to_point( geometry_msgs::Vector3 the_point )
-  {
-    float x_r = the_robot_pose.position.linear.x;
-    float y_r = the_robot_pose.position.linear.y;
-
-    return sqrt(pow(x_r-the_point.x,2)+pow(y_r-the_point.y,2));
-  }
-
-  float P_update(float difference_angle)
-  {
-    float error = difference_angle;
-
-    float angular_vel = (a_P * error);
-    float angular_sat = desire_angular_sat;
-
-    // ROS_INFO("angular vel = %lf and %lf", angular_vel, angular_sat);
-
-    if(angular_vel > angular_sat) { angular_vel = angular_sat; }
-    else if(angular_vel < -angular_sat) { angular_vel = -angular_sat; }
-
-    return angular_vel;
-  }
-
-  float compute_diff_angle(geometry_msgs::Vector3 to_follow)
-  {
-    float x_r = the_robot_pose.position.linear.x;
-    float y_r = the_robot_pose.position.linear.y;
-    float a_r = the_robot_pose.position.angular.z;
-
-    float x = (to_follow.x - x_r) * cos(a_r) + (to_follow.y - y_r) * sin(a_r);
-    float y = - (to_follow.x - x_r) * sin(a_r) + (to_follow.y - y_r) * cos(a_r);
-
-    return findangle(x, y);
-  }
-
-  float findangle(float x, float y)
-  {
-    if(x==0)
-    {
-      return pi*sgn(y);
-    }
-    else if((x<0)&&(y>0))
-    {
-      return atan(y/x) + pi;
-    }
-    else if ((x<0)&&(y<0))
-    {
-      return atan(y/x) - pi;
-    }
-    else
-    {
-      return atan(y/x);
-    }
-    // return atan(x/y);
-  }
-
   robo7_msgs::wallPoint discretize_the_path( robo7_msgs::target_trajectory trajectory , float l )
   {
     robo7_msgs::wallPoint discretized_path;
@@ -355,24 +273,25 @@ private:
     return sqrt(pow(point1.x-point2.x,2)+pow(point1.y-point2.y,2));
   }
 
-  int sgn(float v)
-  {
-    if (v < 0) return -1;
-    else if (v > 0) return 1;
-    else return 0;
-  }
-
-  bool free_road( robo7_msgs::wallPoint discretized_path , int index )
+  //The next points of the path in one request
+  bool free_road( const robo7_msgs::wallPoint &discretized_path , int index )
   {
-    robo7_srvs::IsGridOccupied::Request req1;
-		robo7_srvs::IsGridOccupied::Response res1;
+    robo7_srvs::IsGridOccupiedBatch::Request req1;
+    robo7_srvs::IsGridOccupiedBatch::Response res1;
     for(int i=index; (i<discretized_path.number)&&(i<index+3); i++)
     {
-      req1.x = discretized_path.the_points[i].x;
-      req1.y = discretized_path.the_points[i].y;
-      is_cell_occupied_srv.call(req1,res1);
+      req1.x.push_back(discretized_path.the_points[i].x);
+      req1.y.push_back(discretized_path.the_points[i].y);
+    }
 
-      if(res1.occupancy == 1)
+    if(!are_cells_occupied_srv.call(req1,res1))
+    {
+      return true;
+    }
+
+    for(int i=0; i<static_cast<int>(res1.occupancies.size()); i++)
+    {
+      if(res1.occupancies[i] == 1)
       {
         return false;
       }
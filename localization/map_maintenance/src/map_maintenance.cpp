@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <Eigen/Geometry>
+#include <heuristic_grids/grid2d.h>
 
 //The messages
 #include <geometry_msgs/Twist.h>
@@ -151,6 +152,7 @@ public:
 		if(new_change)
 		{
 			//Publish the occupancy grid
+			fill_occupancy_grid_msg();
 			occupancy_grid_pub.publish(the_occupancy_grid);
 
 			//Update configuration space
@@ -173,8 +175,9 @@ private:
 	robo7_msgs::the_robot_position previous_update_pose;
 	robo7_msgs::detectedObstacle obstacle_msg;
 
-	//The occupancy grid msg
+	//The occupancy grid msg, its cells are only filled in from occupancy_cells when published
 	robo7_msgs::mapping_grid the_occupancy_grid;
+	heuristic_grids::Grid2D<float> occupancy_cells;
 	std::vector<geometry_msgs::Vector3> obstacle_vect;
 	robo7_msgs::allObstacles all_obstacles_msg;
 	robo7_msgs::wallPoint the_new_points_msg;
@@ -220,12 +223,11 @@ private:
 			if(distance_robot_point( robot_pose , map_lidar_scan.the_points[i] ) < lidar_distance_thres )
 			{
 				std::vector<int> the_cell = corresponding_cell(map_lidar_scan.the_points[i].x, map_lidar_scan.the_points[i].y);
-				if((the_cell[0] > 0)&&(the_cell[0] < the_occupancy_grid.occupancy_grid.nb_rows)
-						&&(the_cell[1] > 0)&&(the_cell[1] < the_occupancy_grid.occupancy_grid.nb_cols))
+				if((the_cell[0] > 0)&&(the_cell[1] > 0)&&occupancy_cells.withinGrid(the_cell[0], the_cell[1]))
 						{
 							if(check_free_around_it(the_cell[0], the_cell[1]))
 							{
-								the_occupancy_grid.occupancy_grid.rows[the_cell[0]].cols[the_cell[1]] = occupied;
+								occupancy_cells(the_cell[0], the_cell[1]) = occupied;
 								new_change = true;
 								the_new_points_msg.number++;
 								the_new_points_msg.the_points.push_back(map_lidar_scan.the_points[i]);
@@ -357,11 +359,7 @@ private:
 				std::vector<int> local_cell(2.0);
 				local_cell[0] = the_obstacle_cell[0] + i;
 				local_cell[1] = the_obstacle_cell[1] + j;
-				if((local_cell[0] >= 0)&&(local_cell[0] < the_occupancy_grid.occupancy_grid.nb_rows)
-						&&(local_cell[1] >= 0)&&(local_cell[1] < the_occupancy_grid.occupancy_grid.nb_cols))
-						{
-							the_occupancy_grid.occupancy_grid.rows[local_cell[0]].cols[local_cell[1]] = obstacle;
-						}
+				occupancy_cells.set(local_cell[0], local_cell[1], obstacle);
 			}
 		}
 	}
@@ -376,14 +374,10 @@ private:
 				std::vector<int> local_cell(2,0);
 				local_cell[0] = i_ind + i;
 				local_cell[1] = j_ind + j;
-				if((local_cell[0] >= 0)&&(local_cell[0] < the_occupancy_grid.occupancy_grid.nb_rows)
-						&&(local_cell[1] >= 0)&&(local_cell[1] < the_occupancy_grid.occupancy_grid.nb_cols))
-						{
-							if(the_occupancy_grid.occupancy_grid.rows[local_cell[0]].cols[local_cell[1]] == occupied)
-							{
-								return false;
-							}
-						}
+				if(occupancy_cells.at(local_cell[0], local_cell[1], 0) == occupied)
+				{
+					return false;
+				}
 			}
 		}
 
@@ -402,25 +396,28 @@ private:
 		the_occupancy_grid.top_left_corner.x = x_min - cell_size/2;
 		the_occupancy_grid.top_left_corner.y = y_min - cell_size/2;
 		//Define the occupancy matrix
-		robo7_msgs::matrix the_matrix;
-		the_matrix.nb_rows = (int)(the_occupancy_grid.window_width / the_occupancy_grid.cell_size + 2);
-		the_matrix.nb_cols = (int)(the_occupancy_grid.window_height / the_occupancy_grid.cell_size + 2);
-		robo7_msgs::matrix_row one_row;
-		for(int i=0; i<the_matrix.nb_cols; i++)
+		int nb_rows = (int)(the_occupancy_grid.window_width / the_occupancy_grid.cell_size + 2);
+		int nb_cols = (int)(the_occupancy_grid.window_height / the_occupancy_grid.cell_size + 2);
+		occupancy_cells.reset(nb_rows, nb_cols, cell_size, 0);
+		for(int i=0; i<the_wall_points.number; i++)
 		{
-			one_row.cols.push_back(0);
+			std::vector<int> the_cell = corresponding_cell(the_wall_points.corners[i].x, the_wall_points.corners[i].y);
+			occupancy_cells.set(the_cell[0], the_cell[1], occupied);
 		}
+		fill_occupancy_grid_msg();
+	}
+
+	//Copies the cells into the nested rows of the message
+	void fill_occupancy_grid_msg()
+	{
+		robo7_msgs::matrix &the_matrix = the_occupancy_grid.occupancy_grid;
+		the_matrix.nb_rows = occupancy_cells.numGridSquaresX();
+		the_matrix.nb_cols = occupancy_cells.numGridSquaresY();
+		the_matrix.rows.resize(the_matrix.nb_rows);
 		for(int i=0; i < the_matrix.nb_rows; i++)
 		{
-			the_matrix.rows.push_back(one_row);
-		}
-		for(int i=0; i<the_wall_points.number; i++)
-		{
-			std::vector<int> the_cell = corresponding_cell(the_wall_points.corners[i].x, the_wall_points.corners[i].y);
-			// ROS_INFO("%d, %d, %d, %d", the_matrix.nb_rows, the_matrix.nb_cols, the_cell[0], the_cell[1]);
-			the_matrix.rows[the_cell[0]].cols[the_cell[1]] = occupied;
+			the_matrix.rows[i].cols.assign(occupancy_cells.row(i), occupancy_cells.row(i) + the_matrix.nb_cols);
 		}
-		the_occupancy_grid.occupancy_grid = the_matrix;
 	}
 
 	void find_min_max()
@@ -0,0 +1,130 @@
+#ifndef EXPLORATION_CAMERA_FIELD_H
+#define EXPLORATION_CAMERA_FIELD_H
+
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+#include <heuristic_grids/grid2d.h>
+
+// Squares of the exploration grid the camera sees from a pose. The field is
+// a trapezoid in front of the robot, width / 2 - height / 3 to each side at
+// the robot and width / 2 at distance height. It is rasterized row by row
+// over the grid, and walls hide what is behind them by one ray per angular
+// bin instead of one ray per square.
+
+static const uint8_t CAMERA_FIELD_UNSEEN = 0;
+static const uint8_t CAMERA_FIELD_SEEN = 1;
+// Seen, near the far or side edges of the field where frontiers are placed
+static const uint8_t CAMERA_FIELD_EDGE = 2;
+
+class CameraField
+{
+  public:
+	CameraField();
+
+	void configure(float width, float height, float grid_square_size);
+
+	// Calls visit(i, j_begin, j_end, state) for the rows of squares the field
+	// covers, state[j - j_begin] for j in [j_begin, j_end) being one of
+	// CAMERA_FIELD_*. Squares of wall_grid at 1.0 and outside it block the
+	// view, squares closer than 0.1 m are always seen.
+	template <typename Visit>
+	void sweep(const heuristic_grids::Grid2D<float> &wall_grid, float x, float y, float theta, Visit visit)
+	{
+		int num_grid_squares_x = wall_grid.numGridSquaresX();
+		int num_grid_squares_y = wall_grid.numGridSquaresY();
+		float forward_x = cos(theta), forward_y = sin(theta);
+
+		castRays(wall_grid, x, y, forward_x, forward_y);
+
+		// Bounding box of the corners
+		float corners_u[4] = {-near_half_width, near_half_width, -far_half_width, far_half_width};
+		float corners_v[4] = {0, 0, height, height};
+		float x_min = x, x_max = x;
+
+		for (int k = 0; k < 4; k++)
+		{
+			float corner_x = x + corners_v[k] * forward_x - corners_u[k] * forward_y;
+			x_min = std::min(x_min, corner_x);
+			x_max = std::max(x_max, corner_x);
+		}
+
+		int i_begin = std::max(int(floor(x_min / grid_square_size)), 0);
+		int i_end = std::min(int(floor(x_max / grid_square_size)) + 1, num_grid_squares_x);
+
+		for (int i = i_begin; i < i_end; i++)
+		{
+			// Along the row the field coordinates of the square centres are
+			// v0 + j * dv forward and u0 + j * du to the left
+			float dx = (i + 0.5) * grid_square_size - x;
+			float dy = 0.5 * grid_square_size - y;
+			float v0 = dx * forward_x + dy * forward_y, dv = grid_square_size * forward_y;
+			float u0 = dy * forward_x - dx * forward_y, du = grid_square_size * forward_x;
+
+			int j_begin = 0, j_end = num_grid_squares_y;
+
+			if (!span(v0, dv, j_begin, j_end) || !span(height - v0, -dv, j_begin, j_end) ||
+				!span(u0 + v0 / 3 + near_half_width, du + dv / 3, j_begin, j_end) ||
+				!span(near_half_width + v0 / 3 - u0, dv / 3 - du, j_begin, j_end))
+				continue;
+
+			row_state.resize(j_end - j_begin);
+
+			// No branches, the compiler can vectorize over the row
+			for (int j = j_begin; j < j_end; j++)
+			{
+				float v = v0 + j * dv;
+				float u = u0 + j * du;
+				float range_sq = u * u + v * v;
+				float half_width = near_half_width + v / 3;
+
+				// Pseudo angle u / (|u| + |v|) picks the bin
+				float angle = u / (fabsf(u) + fabsf(v) + 1e-9f);
+				int bin = std::min(std::max(int((angle + 1) * 0.5f * num_bins), 0), num_bins - 1);
+
+				bool inside = v >= 0 && v < height && u >= -half_width && u < half_width;
+				bool seen = range_sq <= near_range_sq || range_sq < bin_range_sq[bin];
+				bool edge = v > edge_depth && (v > height - 1.5f * grid_square_size || u < -half_width + grid_square_size || u > half_width - 1.5f * grid_square_size);
+
+				row_state[j - j_begin] = (inside && seen) * (CAMERA_FIELD_SEEN + edge);
+			}
+
+			visit(i, j_begin, j_end, &row_state[0]);
+		}
+	}
+
+  private:
+	// Narrows [j_begin, j_end) to where g0 + j * g1 >= 0, give or take a
+	// square, the exact test is per square. False if nothing is left.
+	static bool span(float g0, float g1, int &j_begin, int &j_end)
+	{
+		if (g1 == 0)
+			return g0 >= 0 && j_begin < j_end;
+
+		// Clamped before the cast, g1 can be tiny
+		float bound = std::min(std::max(-g0 / g1, float(j_begin) - 1), float(j_end) + 1);
+
+		if (g1 > 0)
+			j_begin = std::max(j_begin, int(floor(bound)));
+		else
+			j_end = std::min(j_end, int(ceil(bound)) + 1);
+
+		return j_begin < j_end;
+	}
+
+	// Squared distance to the first wall along the middle of every bin
+	void castRays(const heuristic_grids::Grid2D<float> &wall_grid, float x, float y, float forward_x, float forward_y);
+
+	float height, near_half_width, far_half_width;
+	float grid_square_size;
+	float edge_depth, near_range_sq, max_range;
+	int num_bins;
+
+	// How far the ray of a bin is cast, 0 for no ray
+	std::vector<float> bin_length;
+	std::vector<float> bin_range_sq;
+	std::vector<uint8_t> row_state;
+};
+
+#endif
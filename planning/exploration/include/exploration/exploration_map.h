@@ -0,0 +1,89 @@
+#ifndef EXPLORATION_EXPLORATION_MAP_H
+#define EXPLORATION_EXPLORATION_MAP_H
+
+#include <stdint.h>
+#include <vector>
+#include <heuristic_grids/grid2d.h>
+#include "exploration/camera_field.h"
+#include "exploration/frontier_clusters.h"
+#include "exploration/frontier_index.h"
+#include "exploration/summed_area_table.h"
+
+// What the camera has seen of the map and where to look next, behind the
+// /exploration/explore and /exploration/getFrontier services of
+// mapping_grids_server. Kept free of ROS so the same exploration runs in
+// offline tools.
+
+class ExplorationMap
+{
+  public:
+	ExplorationMap();
+
+	// Camera field of width x height [m], frontiers count the unexplored
+	// squares in a window of frontier_window_size squares to each side
+	void configure(float grid_square_size, float window_width, float window_height, int frontier_window_size);
+
+	// Starts over on a map. grid holds the walls inflated by the robot
+	// (1.0), which hide frontiers, wall_grid the thin walls, which hide
+	// squares from the camera.
+	void setGrids(const heuristic_grids::Grid2D<float> &grid, const heuristic_grids::Grid2D<float> &wall_grid);
+
+	// Marks what the camera sees from the pose. Returns the frontier
+	// candidates at the edge of the field, the caller looks up their
+	// occupancy and passes it to addFrontiers.
+	const std::vector<frontier_ptr> &markSeen(float x, float y, float theta);
+
+	// Finishes the update of markSeen with the occupancy of every candidate,
+	// in order. Empty if it is not known, then no frontiers are added.
+	void addFrontiers(const std::vector<float> &occupancies);
+
+	// Cheapest frontier cluster goal from the pose of the last markSeen,
+	// NULL once everything is explored. Valid until the next update.
+	const Frontier *cheapestFrontier();
+
+	// 1.0 explored, -1.0 frontier, 0.0 not seen yet
+	const heuristic_grids::Grid2D<float> &explorationGrid() const
+	{
+		return exploration_grid;
+	}
+
+	size_t numFrontiers() const
+	{
+		return frontiers.size();
+	}
+
+  private:
+	void setExplored(int i, int j, float value);
+
+	// Cost of a frontier from the last explored pose
+	float frontierCost(const Frontier &frontier);
+	// The part of the cost that does not depend on the pose
+	float frontierBaseCost(const Frontier &frontier);
+	float getExplorationGainCost(const Frontier &frontier);
+	float getDistanceCost(float distance, float threshold);
+	bool frontierVisible(const Frontier &frontier);
+	int countUnexplored(int i, int j);
+
+	float grid_square_size;
+	float window_width, window_height;
+	int frontier_window_size;
+
+	heuristic_grids::Grid2D<float> grid, wall_grid;
+	heuristic_grids::Grid2D<float> exploration_grid;
+	// Unexplored (0.0) squares of the exploration grid
+	SummedAreaTable unexplored_counts;
+
+	FrontierIndex frontiers;
+	FrontierClusters frontier_clusters;
+	CameraField camera_field;
+
+	// Candidates of the last markSeen and the squares it changed
+	std::vector<frontier_ptr> candidates;
+	int changed_i_min, changed_j_min, changed_i_max, changed_j_max;
+
+	// Pose of the last markSeen
+	float robot_x, robot_y;
+	uint32_t robot_pose;
+};
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef EXPLORATION_FRONTIER_CLUSTERS_H
+#define EXPLORATION_FRONTIER_CLUSTERS_H
+
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+#include <heuristic_grids/grid2d.h>
+#include "exploration/frontier_index.h"
+
+// Frontier squares grouped into 8-connected clusters, one goal per cluster
+// instead of one per square, so the robot is not sent to the square next to
+// the last goal. Clusters are kept in a heap on the part of their cost that
+// does not depend on the robot pose, which bounds the full cost from below.
+//
+// Frontiers are added, removed and marked changed one by one, update() then
+// only groups again the clusters they touch. Heap entries of clusters that
+// were grouped again are dropped when they come up.
+
+struct FrontierCluster
+{
+	// Mean of the member squares
+	float x, y;
+
+	// Member closest to the centroid, where the robot is sent
+	const Frontier *goal;
+
+	float base_cost;
+
+	// Full cost for the pose it was computed at
+	uint32_t cost_pose;
+	float cost;
+
+	// Bumped every time the cluster is dissolved
+	uint32_t generation;
+	bool alive;
+};
+
+class FrontierClusters
+{
+  public:
+	FrontierClusters();
+
+	void reset(int num_grid_squares_x, int num_grid_squares_y);
+
+	void insert(const frontier_ptr &frontier);
+	void remove(const Frontier &frontier);
+
+	// The base cost of the frontier changed
+	void changed(const Frontier &frontier);
+
+	// Groups again the clusters touched since the last update.
+	// base_cost(frontier) is the cost of a goal without the parts depending
+	// on the pose.
+	template <typename BaseCost>
+	void update(BaseCost base_cost)
+	{
+		flood++;
+
+		for (size_t k = 0; k < seeds.size(); k++)
+		{
+			int32_t seed = seeds[k];
+
+			if (!members[seed].frontier || flooded[seed] == flood)
+				continue;
+
+			int32_t cluster = regroup(seed);
+			clusters[cluster].base_cost = base_cost(*clusters[cluster].goal);
+			pushHeap(cluster);
+		}
+
+		seeds.clear();
+		finishUpdate();
+	}
+
+	bool empty() const
+	{
+		return live_clusters == 0;
+	}
+
+	size_t size() const
+	{
+		return live_clusters;
+	}
+
+	// Cluster with the lowest cost(cluster) >= base_cost for the pose
+	// numbered pose, counted from 1. Clusters are taken off the heap by base
+	// cost until no remaining one can beat the best full cost found, then
+	// put back. Full costs are kept until the pose number changes.
+	template <typename Cost>
+	const FrontierCluster *cheapest(uint32_t pose, Cost cost)
+	{
+		size_t end = heap.size();
+		int best = -1;
+
+		while (end > 0 && (best < 0 || heap[0].base_cost < clusters[best].cost))
+		{
+			std::pop_heap(heap.begin(), heap.begin() + end, Cheaper());
+			end--;
+
+			FrontierCluster &cluster = clusters[heap[end].cluster];
+
+			// Grouped again since it was pushed
+			if (!cluster.alive || cluster.generation != heap[end].generation)
+			{
+				heap[end] = heap.back();
+				heap.pop_back();
+				continue;
+			}
+
+			if (cluster.cost_pose != pose)
+			{
+				cluster.cost = cost(cluster);
+				cluster.cost_pose = pose;
+			}
+
+			if (best < 0 || cluster.cost < clusters[best].cost)
+				best = heap[end].cluster;
+		}
+
+		while (end < heap.size())
+			std::push_heap(heap.begin(), heap.begin() + ++end, Cheaper());
+
+		return best < 0 ? NULL : &clusters[best];
+	}
+
+  private:
+	struct Member
+	{
+		// NULL for a free slot
+		frontier_ptr frontier;
+		// Next member on the same square, or next free slot
+		int32_t next;
+		int32_t cluster;
+	};
+
+	struct HeapEntry
+	{
+		float base_cost;
+		uint32_t cluster;
+		uint32_t generation;
+	};
+
+	// Top of the heap is the lowest base cost
+	struct Cheaper
+	{
+		bool operator()(const HeapEntry &a, const HeapEntry &b) const
+		{
+			return a.base_cost > b.base_cost;
+		}
+	};
+
+	int32_t findMember(const Frontier &frontier) const;
+	void addSeeds(int i, int j);
+	void dissolve(int32_t cluster);
+	int32_t regroup(int32_t seed);
+	void pushHeap(int32_t cluster);
+	void finishUpdate();
+
+	// First member on a square, -1 if none
+	heuristic_grids::Grid2D<int32_t> first;
+
+	std::vector<Member> members;
+	std::vector<int32_t> free_members;
+
+	// Members whose cluster has to be grouped again
+	std::vector<int32_t> seeds;
+
+	// Members reached by the flood numbered flood
+	std::vector<uint32_t> flooded;
+	uint32_t flood;
+	std::vector<int32_t> stack, cluster_members;
+
+	std::vector<FrontierCluster> clusters;
+	size_t live_clusters;
+
+	// Dissolved in this update, reused from the next one on
+	std::vector<int32_t> dissolved, free_clusters;
+
+	std::vector<HeapEntry> heap;
+};
+
+#endif
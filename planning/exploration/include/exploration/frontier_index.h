@@ -0,0 +1,110 @@
+#ifndef EXPLORATION_FRONTIER_INDEX_H
+#define EXPLORATION_FRONTIER_INDEX_H
+
+#include <algorithm>
+#include <memory>
+#include <stddef.h>
+#include <vector>
+
+// Frontier squares of the exploration grid, bucketed by area so an update of
+// the grid only revisits the frontiers near the squares it changed.
+
+class Frontier
+{
+  public:
+	Frontier(float x, float y, int i, int j, float occupancy_cost, int number_unexplored)
+		: x(x), y(y), i(i), j(j), occupancy_cost(occupancy_cost), number_unexplored(number_unexplored)
+	{
+	}
+
+	bool inCollision() const
+	{
+		return occupancy_cost >= 1.0;
+	}
+
+	float x, y;
+	// Square of the frontier in the exploration grid
+	int i, j;
+	float occupancy_cost;
+	// Unexplored squares in the window around the frontier
+	int number_unexplored;
+};
+
+typedef std::shared_ptr<Frontier> frontier_ptr;
+
+class FrontierIndex
+{
+  public:
+	FrontierIndex();
+
+	// Drops every frontier. Buckets are bucket_size squares wide.
+	void reset(int num_grid_squares_x, int num_grid_squares_y, int bucket_size);
+
+	void insert(const frontier_ptr &frontier);
+
+	size_t size() const
+	{
+		return count;
+	}
+
+	bool empty() const
+	{
+		return count == 0;
+	}
+
+	// Calls visit(frontier) for the frontiers with squares in [i_min, i_max] x
+	// [j_min, j_max]. Frontiers for which it returns false are removed.
+	template <typename Visit>
+	void update(int i_min, int j_min, int i_max, int j_max, Visit visit)
+	{
+		int bucket_i_min = std::max(bucket(i_min), 0), bucket_i_max = std::min(bucket(i_max), num_buckets_x - 1);
+		int bucket_j_min = std::max(bucket(j_min), 0), bucket_j_max = std::min(bucket(j_max), num_buckets_y - 1);
+
+		for (int bucket_i = bucket_i_min; bucket_i <= bucket_i_max; bucket_i++)
+		{
+			for (int bucket_j = bucket_j_min; bucket_j <= bucket_j_max; bucket_j++)
+			{
+				std::vector<frontier_ptr> &frontiers = buckets[bucket_i * num_buckets_y + bucket_j];
+
+				for (size_t k = 0; k < frontiers.size();)
+				{
+					const Frontier &frontier = *frontiers[k];
+
+					if (frontier.i < i_min || frontier.i > i_max || frontier.j < j_min || frontier.j > j_max || visit(frontiers[k]))
+					{
+						k++;
+						continue;
+					}
+
+					// Order within a bucket does not matter
+					frontiers[k] = frontiers.back();
+					frontiers.pop_back();
+					count--;
+				}
+			}
+		}
+	}
+
+	// Calls visit(frontier) for every frontier, in no particular order
+	template <typename Visit>
+	void forEach(Visit visit) const
+	{
+		for (size_t b = 0; b < buckets.size(); b++)
+		{
+			for (size_t k = 0; k < buckets[b].size(); k++)
+				visit(buckets[b][k]);
+		}
+	}
+
+  private:
+	int bucket(int i) const
+	{
+		return i >= 0 ? i / bucket_size : -1;
+	}
+
+	int num_buckets_x, num_buckets_y, bucket_size;
+	std::vector<std::vector<frontier_ptr> > buckets;
+	size_t count;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef EXPLORATION_SUMMED_AREA_TABLE_H
+#define EXPLORATION_SUMMED_AREA_TABLE_H
+
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+#include <heuristic_grids/grid2d.h>
+
+// Number of squares of a grid holding one value, e.g. the unexplored squares
+// of the exploration grid, over any rectangle from four lookups.
+
+class SummedAreaTable
+{
+  public:
+	SummedAreaTable();
+
+	// Counts the squares of the grid equal to value
+	void build(const heuristic_grids::Grid2D<float> &grid, float value);
+
+	// Redoes the table after squares in [i_min, i_max] x [j_min, j_max]
+	// changed. Every sum past the corner (i_min, j_min) depends on them.
+	void update(const heuristic_grids::Grid2D<float> &grid, int i_min, int j_min, int i_max, int j_max);
+
+	// Squares in [i_min, i_max] x [j_min, j_max] equal to the value, the part
+	// outside the grid counts none
+	int count(int i_min, int j_min, int i_max, int j_max) const
+	{
+		i_min = std::max(i_min, 0);
+		j_min = std::max(j_min, 0);
+		i_max = std::min(i_max, num_grid_squares_x - 1);
+		j_max = std::min(j_max, num_grid_squares_y - 1);
+
+		if (i_min > i_max || j_min > j_max)
+			return 0;
+
+		return sum(i_max + 1, j_max + 1) - sum(i_min, j_max + 1) - sum(i_max + 1, j_min) + sum(i_min, j_min);
+	}
+
+  private:
+	// Squares [0, i) x [0, j)
+	int32_t sum(int i, int j) const
+	{
+		return sums[size_t(i) * (num_grid_squares_y + 1) + j];
+	}
+
+	void compute(const heuristic_grids::Grid2D<float> &grid, int i_min, int j_min);
+
+	int num_grid_squares_x, num_grid_squares_y;
+	float value;
+	std::vector<int32_t> sums;
+};
+
+#endif
@@ -0,0 +1,85 @@
+#include "exploration/camera_field.h"
+
+#include <heuristic_grids/grid_traversal.h>
+
+CameraField::CameraField()
+{
+	configure(.45, .45, .02);
+}
+
+void CameraField::configure(float width, float height, float grid_square_size)
+{
+	this->height = height;
+	this->grid_square_size = grid_square_size;
+	near_half_width = width / 2 - height / 3;
+	far_half_width = width / 2;
+
+	// Frontiers start 10 squares out, the view is not checked within 0.1 m
+	edge_depth = 10 * grid_square_size;
+	near_range_sq = .1 * .1;
+	max_range = sqrt(height * height + far_half_width * far_half_width) + grid_square_size;
+
+	// A bin is at most 4 / num_bins rad wide, a square at max range
+	num_bins = std::max(int(ceil(4 * max_range / grid_square_size)), 1);
+	bin_range_sq.resize(num_bins);
+	bin_length.resize(num_bins);
+
+	// Rays only need to reach the far or side edge of the field, and none
+	// are cast where the field is within 0.1 m anyway
+	for (int bin = 0; bin < num_bins; bin++)
+	{
+		float angle = (bin + 0.5f) * 2 / num_bins - 1;
+		float u = fabsf(angle), v = 1 - fabsf(angle);
+		float length = sqrt(u * u + v * v);
+
+		u /= length;
+		v /= length;
+
+		float edge = v > 0 ? height / v : max_range;
+		if (u > v / 3)
+			edge = std::min(edge, std::max(near_half_width, 0.0f) / (u - v / 3));
+
+		// A square further, the squares of a bin spread out from its middle
+		edge = std::min(edge + grid_square_size, max_range);
+		bin_length[bin] = edge * edge <= near_range_sq ? 0 : edge;
+	}
+}
+
+void CameraField::castRays(const heuristic_grids::Grid2D<float> &wall_grid, float x, float y, float forward_x, float forward_y)
+{
+	for (int bin = 0; bin < num_bins; bin++)
+	{
+		if (bin_length[bin] == 0)
+		{
+			bin_range_sq[bin] = 0;
+			continue;
+		}
+
+		// Direction with pseudo angle at the middle of the bin
+		float angle = (bin + 0.5f) * 2 / num_bins - 1;
+		float u = angle, v = 1 - fabsf(angle);
+		float direction_x = v * forward_x - u * forward_y;
+		float direction_y = v * forward_y + u * forward_x;
+		float length = sqrt(direction_x * direction_x + direction_y * direction_y);
+
+		float x_end = x + direction_x / length * bin_length[bin];
+		float y_end = y + direction_y / length * bin_length[bin];
+
+		heuristic_grids::GridTraversal ray(x, y, x_end, y_end, grid_square_size);
+		// No wall before the edge of the field, nothing in the bin is hidden
+		float enter = 0, range = max_range;
+
+		do
+		{
+			if (wall_grid.at(ray.i(), ray.j(), 1.0) == 1.0)
+			{
+				range = enter * bin_length[bin];
+				break;
+			}
+
+			enter = ray.exit();
+		} while (ray.next());
+
+		bin_range_sq[bin] = range * range;
+	}
+}
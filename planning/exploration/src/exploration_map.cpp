@@ -0,0 +1,209 @@
+#include "exploration/exploration_map.h"
+
+#include <algorithm>
+#include <math.h>
+#include <heuristic_grids/grid_traversal.h>
+
+ExplorationMap::ExplorationMap()
+	: changed_i_min(0), changed_j_min(0), changed_i_max(-1), changed_j_max(-1), robot_x(0), robot_y(0), robot_pose(0)
+{
+	configure(.02, .45, .45, 4);
+}
+
+void ExplorationMap::configure(float grid_square_size, float window_width, float window_height, int frontier_window_size)
+{
+	this->grid_square_size = grid_square_size;
+	this->window_width = window_width;
+	this->window_height = window_height;
+	this->frontier_window_size = frontier_window_size;
+
+	camera_field.configure(window_width, window_height, grid_square_size);
+}
+
+void ExplorationMap::setGrids(const heuristic_grids::Grid2D<float> &grid, const heuristic_grids::Grid2D<float> &wall_grid)
+{
+	this->grid = grid;
+	this->wall_grid = wall_grid;
+
+	int num_grid_squares_x = grid.numGridSquaresX();
+	int num_grid_squares_y = grid.numGridSquaresY();
+
+	exploration_grid.reset(num_grid_squares_x, num_grid_squares_y, grid_square_size);
+	frontiers.reset(num_grid_squares_x, num_grid_squares_y, 2 * frontier_window_size);
+	unexplored_counts.build(exploration_grid, 0.0);
+	frontier_clusters.reset(num_grid_squares_x, num_grid_squares_y);
+	candidates.clear();
+
+	robot_x = 0;
+	robot_y = 0;
+	robot_pose = 0;
+}
+
+void ExplorationMap::setExplored(int i, int j, float value)
+{
+	exploration_grid(i, j) = value;
+	changed_i_min = std::min(changed_i_min, i);
+	changed_j_min = std::min(changed_j_min, j);
+	changed_i_max = std::max(changed_i_max, i);
+	changed_j_max = std::max(changed_j_max, j);
+}
+
+const std::vector<frontier_ptr> &ExplorationMap::markSeen(float x, float y, float theta)
+{
+	// Costs depending on the pose are worked out in cheapestFrontier
+	robot_x = x;
+	robot_y = y;
+	robot_pose++;
+
+	changed_i_min = exploration_grid.numGridSquaresX();
+	changed_j_min = exploration_grid.numGridSquaresY();
+	changed_i_max = -1;
+	changed_j_max = -1;
+	candidates.clear();
+
+	// Get camera field coverage for defining explored cells and frontiers
+	camera_field.sweep(wall_grid, x, y, theta, [&](int i, int j_begin, int j_end, const uint8_t *state) {
+		const float *row = exploration_grid.row(i);
+
+		for (int j = j_begin; j < j_end; j++)
+		{
+			// Seen and not already explored
+			if (state[j - j_begin] == CAMERA_FIELD_UNSEEN || row[j] >= 1.0)
+				continue;
+
+			// At edge of camera field i.e. frontier
+			if (state[j - j_begin] == CAMERA_FIELD_EDGE)
+			{
+				float x_grid = (i + 0.5) * grid_square_size;
+				float y_grid = (j + 0.5) * grid_square_size;
+
+				// Explorability is counted once the field is marked
+				candidates.push_back(std::make_shared<Frontier>(x_grid, y_grid, i, j, 1.0, 0));
+			}
+			else
+				setExplored(i, j, 1.0);
+		}
+	});
+
+	return candidates;
+}
+
+void ExplorationMap::addFrontiers(const std::vector<float> &occupancies)
+{
+	std::vector<frontier_ptr> frontier_nodes;
+
+	// Add frontiers where the space is sufficiently free
+	if (occupancies.size() == candidates.size())
+	{
+		for (size_t k = 0; k < candidates.size(); k++)
+		{
+			frontier_ptr frontier_node = candidates[k];
+			frontier_node->occupancy_cost = occupancies[k];
+
+			// Unless the rest of the field covered it since
+			if (frontier_node->occupancy_cost < .8 && exploration_grid(frontier_node->i, frontier_node->j) != 1.0)
+			{
+				frontier_nodes.push_back(frontier_node);
+				setExplored(frontier_node->i, frontier_node->j, -1.0);
+			}
+		}
+	}
+
+	candidates.clear();
+
+	// Check explorability at the frontiers
+	unexplored_counts.update(exploration_grid, changed_i_min, changed_j_min, changed_i_max, changed_j_max);
+
+	for (size_t k = 0; k < frontier_nodes.size(); k++)
+		frontier_nodes[k]->number_unexplored = countUnexplored(frontier_nodes[k]->i, frontier_nodes[k]->j);
+
+	// Only frontiers with changed squares in their window are looked at
+	// again: covered ones are removed, the others recount their window.
+	// Only the clusters of these are grouped again.
+	if (changed_i_max >= 0)
+	{
+		frontiers.update(changed_i_min - frontier_window_size + 1, changed_j_min - frontier_window_size + 1,
+						 changed_i_max + frontier_window_size, changed_j_max + frontier_window_size, [this](const frontier_ptr &frontier) {
+							 if (exploration_grid(frontier->i, frontier->j) == 1.0)
+							 {
+								 frontier_clusters.remove(*frontier);
+								 return false;
+							 }
+
+							 int number_unexplored = countUnexplored(frontier->i, frontier->j);
+
+							 if (number_unexplored != frontier->number_unexplored)
+							 {
+								 frontier->number_unexplored = number_unexplored;
+								 frontier_clusters.changed(*frontier);
+							 }
+
+							 return true;
+						 });
+	}
+
+	for (size_t k = 0; k < frontier_nodes.size(); k++)
+	{
+		frontiers.insert(frontier_nodes[k]);
+		frontier_clusters.insert(frontier_nodes[k]);
+	}
+
+	frontier_clusters.update([this](const Frontier &frontier) {
+		return frontierBaseCost(frontier);
+	});
+}
+
+// Its cost without distance and visibility is a lower bound, so only the
+// clusters that come out on top are costed from the pose
+const Frontier *ExplorationMap::cheapestFrontier()
+{
+	if (frontier_clusters.empty())
+		return NULL;
+
+	const FrontierCluster *cluster = frontier_clusters.cheapest(robot_pose, [this](const FrontierCluster &candidate) {
+		return frontierCost(*candidate.goal);
+	});
+
+	return cluster->goal;
+}
+
+float ExplorationMap::frontierCost(const Frontier &frontier)
+{
+	float frontier_distance = sqrt(pow(robot_x - frontier.x, 2) + pow(robot_y - frontier.y, 2));
+
+	return frontierBaseCost(frontier) + getDistanceCost(frontier_distance, window_height) + .5 * float(!frontierVisible(frontier));
+}
+
+float ExplorationMap::frontierBaseCost(const Frontier &frontier)
+{
+	return .7 * frontier.occupancy_cost + getExplorationGainCost(frontier);
+}
+
+float ExplorationMap::getExplorationGainCost(const Frontier &frontier)
+{
+	float frontier_area = float(pow(2 * frontier_window_size, 2));
+	return .5 * (frontier_area - float(frontier.number_unexplored)) / frontier_area;
+}
+
+float ExplorationMap::getDistanceCost(float distance, float threshold)
+{
+	if (distance < threshold)
+		return 2 * (threshold - distance);
+	else
+		return 0;
+}
+
+// Not visible if the inflated walls are in the way
+bool ExplorationMap::frontierVisible(const Frontier &frontier)
+{
+	return heuristic_grids::traverseGrid(robot_x, robot_y, frontier.x, frontier.y, grid_square_size, [this](int i, int j) {
+		return grid.at(i, j, 1.0) != 1.0;
+	});
+}
+
+// Unexplored squares in the window around a frontier square, squares
+// outside the map count as explored
+int ExplorationMap::countUnexplored(int i, int j)
+{
+	return unexplored_counts.count(i - frontier_window_size, j - frontier_window_size, i + frontier_window_size - 1, j + frontier_window_size - 1);
+}
@@ -0,0 +1,233 @@
+#include "exploration/frontier_clusters.h"
+
+#include <math.h>
+
+FrontierClusters::FrontierClusters()
+	: flood(0), live_clusters(0)
+{
+}
+
+void FrontierClusters::reset(int num_grid_squares_x, int num_grid_squares_y)
+{
+	first.reset(num_grid_squares_x, num_grid_squares_y, 1, -1);
+	members.clear();
+	free_members.clear();
+	seeds.clear();
+	flooded.clear();
+	flood = 0;
+	clusters.clear();
+	live_clusters = 0;
+	dissolved.clear();
+	free_clusters.clear();
+	heap.clear();
+}
+
+void FrontierClusters::insert(const frontier_ptr &frontier)
+{
+	if (!first.withinGrid(frontier->i, frontier->j))
+		return;
+
+	int32_t member;
+
+	if (free_members.empty())
+	{
+		member = members.size();
+		members.push_back(Member());
+		flooded.push_back(0);
+	}
+	else
+	{
+		member = free_members.back();
+		free_members.pop_back();
+	}
+
+	members[member].frontier = frontier;
+	members[member].cluster = -1;
+	members[member].next = first(frontier->i, frontier->j);
+	first(frontier->i, frontier->j) = member;
+
+	seeds.push_back(member);
+}
+
+void FrontierClusters::remove(const Frontier &frontier)
+{
+	int32_t member = findMember(frontier);
+
+	if (member < 0)
+		return;
+
+	dissolve(members[member].cluster);
+
+	int32_t *link = &first(frontier.i, frontier.j);
+	while (*link != member)
+		link = &members[*link].next;
+	*link = members[member].next;
+
+	members[member].frontier.reset();
+	members[member].cluster = -1;
+	free_members.push_back(member);
+
+	// What is left of its cluster is reached from its neighbours, which may
+	// no longer be connected
+	addSeeds(frontier.i, frontier.j);
+}
+
+void FrontierClusters::changed(const Frontier &frontier)
+{
+	int32_t member = findMember(frontier);
+
+	if (member >= 0)
+		seeds.push_back(member);
+}
+
+int32_t FrontierClusters::findMember(const Frontier &frontier) const
+{
+	for (int32_t k = first.at(frontier.i, frontier.j, -1); k >= 0; k = members[k].next)
+	{
+		if (members[k].frontier.get() == &frontier)
+			return k;
+	}
+
+	return -1;
+}
+
+// Members on the square and the 8 around it
+void FrontierClusters::addSeeds(int i, int j)
+{
+	for (int di = -1; di <= 1; di++)
+	{
+		for (int dj = -1; dj <= 1; dj++)
+		{
+			for (int32_t k = first.at(i + di, j + dj, -1); k >= 0; k = members[k].next)
+				seeds.push_back(k);
+		}
+	}
+}
+
+void FrontierClusters::dissolve(int32_t cluster)
+{
+	if (cluster < 0 || !clusters[cluster].alive)
+		return;
+
+	clusters[cluster].alive = false;
+	clusters[cluster].generation++;
+	live_clusters--;
+	dissolved.push_back(cluster);
+}
+
+// Floods the members 8-connected to the seed into a new cluster, the
+// clusters they belonged to are dissolved
+int32_t FrontierClusters::regroup(int32_t seed)
+{
+	cluster_members.clear();
+	stack.assign(1, seed);
+	flooded[seed] = flood;
+
+	while (!stack.empty())
+	{
+		int32_t member = stack.back();
+		stack.pop_back();
+		cluster_members.push_back(member);
+		dissolve(members[member].cluster);
+
+		const Frontier &frontier = *members[member].frontier;
+
+		for (int di = -1; di <= 1; di++)
+		{
+			for (int dj = -1; dj <= 1; dj++)
+			{
+				for (int32_t k = first.at(frontier.i + di, frontier.j + dj, -1); k >= 0; k = members[k].next)
+				{
+					if (flooded[k] == flood)
+						continue;
+
+					flooded[k] = flood;
+					stack.push_back(k);
+				}
+			}
+		}
+	}
+
+	int32_t index;
+
+	if (free_clusters.empty())
+	{
+		index = clusters.size();
+		clusters.push_back(FrontierCluster());
+		clusters[index].generation = 0;
+	}
+	else
+	{
+		index = free_clusters.back();
+		free_clusters.pop_back();
+	}
+
+	FrontierCluster &cluster = clusters[index];
+	int size = cluster_members.size();
+
+	cluster.x = 0;
+	cluster.y = 0;
+
+	for (size_t k = 0; k < cluster_members.size(); k++)
+	{
+		cluster.x += members[cluster_members[k]].frontier->x / size;
+		cluster.y += members[cluster_members[k]].frontier->y / size;
+	}
+
+	// The centroid of a bent frontier can be off it, the goal is not
+	float goal_distance = -1;
+
+	for (size_t k = 0; k < cluster_members.size(); k++)
+	{
+		const Frontier *member = members[cluster_members[k]].frontier.get();
+		float distance = pow(member->x - cluster.x, 2) + pow(member->y - cluster.y, 2);
+
+		if (goal_distance < 0 || distance < goal_distance)
+		{
+			goal_distance = distance;
+			cluster.goal = member;
+		}
+
+		members[cluster_members[k]].cluster = index;
+	}
+
+	cluster.base_cost = 0;
+	cluster.cost_pose = 0;
+	cluster.cost = 0;
+	cluster.alive = true;
+	live_clusters++;
+
+	return index;
+}
+
+void FrontierClusters::pushHeap(int32_t cluster)
+{
+	HeapEntry entry = {clusters[cluster].base_cost, uint32_t(cluster), clusters[cluster].generation};
+
+	heap.push_back(entry);
+	std::push_heap(heap.begin(), heap.end(), Cheaper());
+}
+
+void FrontierClusters::finishUpdate()
+{
+	free_clusters.insert(free_clusters.end(), dissolved.begin(), dissolved.end());
+	dissolved.clear();
+
+	// Entries of dissolved clusters are only dropped when they come up,
+	// rebuild once they are the most of the heap
+	if (heap.size() <= 2 * live_clusters + 64)
+		return;
+
+	heap.clear();
+
+	for (size_t k = 0; k < clusters.size(); k++)
+	{
+		if (clusters[k].alive)
+		{
+			HeapEntry entry = {clusters[k].base_cost, uint32_t(k), clusters[k].generation};
+			heap.push_back(entry);
+		}
+	}
+
+	std::make_heap(heap.begin(), heap.end(), Cheaper());
+}
@@ -0,0 +1,25 @@
+#include "exploration/frontier_index.h"
+
+FrontierIndex::FrontierIndex()
+	: num_buckets_x(0), num_buckets_y(0), bucket_size(1), count(0)
+{
+}
+
+void FrontierIndex::reset(int num_grid_squares_x, int num_grid_squares_y, int bucket_size)
+{
+	this->bucket_size = std::max(bucket_size, 1);
+	num_buckets_x = std::max((num_grid_squares_x + this->bucket_size - 1) / this->bucket_size, 1);
+	num_buckets_y = std::max((num_grid_squares_y + this->bucket_size - 1) / this->bucket_size, 1);
+
+	buckets.assign(size_t(num_buckets_x) * num_buckets_y, std::vector<frontier_ptr>());
+	count = 0;
+}
+
+void FrontierIndex::insert(const frontier_ptr &frontier)
+{
+	int bucket_i = std::min(std::max(bucket(frontier->i), 0), num_buckets_x - 1);
+	int bucket_j = std::min(std::max(bucket(frontier->j), 0), num_buckets_y - 1);
+
+	buckets[bucket_i * num_buckets_y + bucket_j].push_back(frontier);
+	count++;
+}
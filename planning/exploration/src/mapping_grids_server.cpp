@@ -2,10 +2,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <string>
 #include <vector>
 #include "ros/ros.h"
 #include "std_msgs/Bool.h"
-#include "robo7_srvs/IsGridOccupied.h"
+#include "robo7_srvs/IsGridOccupiedBatch.h"
 #include "robo7_srvs/explore.h"
 #include "robo7_srvs/getFrontier.h"
 #include "robo7_msgs/XY_coordinates.h"
@@ -18,66 +19,17 @@
 #include "robo7_msgs/grid_row.h"
 #include "robo7_msgs/detectedState.h"
 #include "robo7_srvs/distanceTo.h"
+#include <heuristic_grids/distance_field.h>
+#include <heuristic_grids/grid_cache.h>
+#include <heuristic_grids/grid2d_mat.h>
+#include <heuristic_grids/wall_inflation.h>
+#include "exploration/exploration_map.h"
 
-typedef std::vector<float> Array;
-typedef std::vector<Array> Matrix;
 float window_width, window_height;
-int frontier_window_size, unexplored_threshold;
+int frontier_window_size;
 
-class Frontier;
-
-typedef std::shared_ptr<Frontier> frontier_ptr;
 float pi = 3.14159265358979323846;
 
-class Frontier
-{
-  public:
-	float x, y, occupancy_cost, theta_diff, frontier_distance, not_visable;
-	int number_unexplored;
-
-	Frontier(float x, float y, float occupancy_cost, float theta_diff, float frontier_distance, int number_unexplored)
-	{
-		this->x = x;
-		this->y = y;
-		this->occupancy_cost = occupancy_cost;
-		this->theta_diff = theta_diff;
-		this->frontier_distance = frontier_distance;
-		this->number_unexplored = number_unexplored;
-
-		not_visable = false;
-	}
-
-	float getCost()
-	{
-		return .7 * occupancy_cost + getExplorationGainCost() + getDistanceCost(frontier_distance, window_height) + .5 * float(not_visable);
-	}
-
-	float getExplorationGainCost()
-	{
-		float frontier_area = float(pow(2 * frontier_window_size, 2));
-		return .5 * (frontier_area - float(number_unexplored)) / frontier_area;
-	}
-
-	float getDistanceCost(float distance, float threshold)
-	{
-		if (distance < threshold)
-			return 2 * (threshold - distance);
-		else
-			return 0;
-	}
-
-	float gaussian(float x, float mean, float var)
-	{
-		float diff = (x - mean) / var;
-		return std::exp(-pow(diff, 2) / 2);
-	}
-
-	bool inCollision()
-	{
-		return occupancy_cost >= 1.0;
-	}
-};
-
 class MappingGridsServer
 {
   public:
@@ -86,13 +38,13 @@ class MappingGridsServer
 	ros::Publisher occupancy_pub, wall_occupancy_pub, exploration_pub;
 	robo7_msgs::grid_matrix grid_matrix_msg, exoploration_matrix_msg;
 	ros::ServiceServer explore_service, getFrontier_service;
-	robo7_srvs::IsGridOccupied occupancy_srv;
-	ros::ServiceClient occupancy_client, distance_client;
+	robo7_srvs::IsGridOccupiedBatch occupancy_batch_srv;
+	ros::ServiceClient occupancy_batch_client, distance_client;
 	robo7_srvs::distanceTo distance_srv;
 
-	std::vector<frontier_ptr> all_frontiers_nodes;
+	ExplorationMap exploration_map;
 	// Occupancy of inflated map grid and original map
-	Matrix grid, wall_grid;
+	heuristic_grids::Grid2D<float> grid, wall_grid;
 	bool get_frontier;
 	std::vector<int> detected_object_states;
 
@@ -104,6 +56,10 @@ class MappingGridsServer
 		n.param<float>("/mapping_grids_server/wall_thickness", wall_thickness, 0.03);
 		n.param<int>("/mapping_grids_server/smoothing_kernel_size", smoothing_kernel_size, 15);
 		n.param<int>("/mapping_grids_server/smoothing_kernel_sd", smoothing_kernel_sd, 3);
+		n.param<bool>("/mapping_grids_server/use_grid_cache", use_grid_cache, true);
+		n.param<std::string>("/mapping_grids_server/grid_cache_directory", grid_cache_directory, heuristic_grids::defaultGridCacheDirectory());
+		// Half width of the window frontiers count unexplored squares in, in squares
+		n.param<int>("/mapping_grids_server/frontier_window_size", frontier_window_size, 4);
 
 		detected_obj_subs = n.subscribe("/vision/state", 1, &MappingGridsServer::detectedObjectCallback, this);
 		map_sub = n.subscribe("/own_map/wall_coordinates", 1, &MappingGridsServer::mapCallback, this);
@@ -113,7 +69,7 @@ class MappingGridsServer
 
 		exploration_pub = n.advertise<robo7_msgs::grid_matrix>("/mapping_grids_server/exploration_matrix", 1);
 
-		occupancy_client = n.serviceClient<robo7_srvs::IsGridOccupied>("/occupancy_grid/is_occupied");
+		occupancy_batch_client = n.serviceClient<robo7_srvs::IsGridOccupiedBatch>("/occupancy_grid/is_occupied_batch");
 
 		distance_client = n.serviceClient<robo7_srvs::distanceTo>("/distance_grid/distance");
 
@@ -128,172 +84,37 @@ class MappingGridsServer
 
 		window_width = .45;
 		window_height = .45;
-		unexplored_threshold = 25;
-		frontier_window_size = 4;
+		exploration_map.configure(grid_square_size, window_width, window_height, frontier_window_size);
+
+		exploration_grid_init = false;
 	}
 
 	bool exploreHere(robo7_srvs::explore::Request &req, robo7_srvs::explore::Response &res)
 	{
-		float x = req.x;
-		float y = req.y;
-		float theta = req.theta;
-
-		std::vector<frontier_ptr> frontier_nodes;
-
 		if (!exploration_grid_init)
 		{
-			exploration_grid = cv::Mat::zeros(num_grid_squares_x, num_grid_squares_y, CV_32SC1);
+			exploration_map.setGrids(grid, wall_grid);
 			exploration_grid_init = true;
 		}
 
-		theta = pi / 2 - theta;
+		// Frontier candidates of the camera field, their occupancy is asked
+		// for in one batch once the field is covered
+		const std::vector<frontier_ptr> &candidates = exploration_map.markSeen(req.x, req.y, req.theta);
+		std::vector<float> occupancies;
 
-		float i0 = x + window_width * cos(theta) / 2.0;
-		float j0 = y - window_width * sin(theta) / 2.0;
+		occupancy_batch_srv.request.x.clear();
+		occupancy_batch_srv.request.y.clear();
 
-		float i_inc = float(cos(theta) * grid_square_size) / 2.0;
-		float j_inc = float(sin(theta) * grid_square_size) / 2.0;
-		float j_max = float(window_height / grid_square_size);
-		float x_grid, y_grid, x_ray, y_ray, i_shift, i_max;
-
-		float x_frontier, y_frontier, frontier_distance, x_diff, y_diff, theta_diff;
-
-		// Remove overwritten frontiers
-		for (int i = 0; i < all_frontiers_nodes.size(); i++)
+		for (size_t k = 0; k < candidates.size(); k++)
 		{
-			x_frontier = all_frontiers_nodes[i]->x;
-			y_frontier = all_frontiers_nodes[i]->y;
-
-			if (exploration_grid.at<float>(sq(x_frontier), sq(y_frontier)) == 1.0)
-				all_frontiers_nodes.erase(all_frontiers_nodes.begin() + i);
-			else
-			{
-				frontier_distance = distance(x, y, x_frontier, y_frontier);
-				all_frontiers_nodes[i]->frontier_distance = frontier_distance;
-
-				x_diff = float(x_frontier - x);
-				y_diff = float(y_frontier - y);
-				theta_diff = std::abs(std::fmod(theta - atan2(y_diff, x_diff) + pi, 2 * pi) - pi);
-				all_frontiers_nodes[i]->theta_diff = theta_diff;
-
-				int number_unexplored = 0;
-				for (int i_frontier = sq(x_frontier) - frontier_window_size; i_frontier < sq(x_frontier) + frontier_window_size; i_frontier++)
-				{
-					for (int j_frontier = sq(y_frontier) - frontier_window_size; j_frontier < sq(y_frontier) + frontier_window_size; j_frontier++)
-					{
-						if (exploration_grid.at<float>(i_frontier, j_frontier) == 0.0)
-						{
-							number_unexplored++;
-						}
-					}
-				}
-				all_frontiers_nodes[i]->number_unexplored = number_unexplored;
-
-				int n = 4 * std::max(std::max(std::abs(sq(x_diff)), std::abs(sq(y_diff))), 20);
-				bool not_visable = false;
-
-				x_ray = x;
-				y_ray = y;
-
-				for (int i_ray = 0; i_ray < n; i_ray++)
-				{
-					x_ray += x_diff / n;
-					y_ray += y_diff / n;
-
-					if (grid[sq(x_ray)][sq(y_ray)] == 1.0)
-					{
-						not_visable = true;
-						break;
-					}
-				}
-				all_frontiers_nodes[i]->not_visable = not_visable;
-			}
+			occupancy_batch_srv.request.x.push_back(candidates[k]->x);
+			occupancy_batch_srv.request.y.push_back(candidates[k]->y);
 		}
 
-		bool add_exploration_cell;
-
-		// Get camera field coverage for defining explored cells and frontiers
-		for (float j = 0.0; j < j_max; j += .5)
-		{
-			i_shift = j_max / 3 - j / 3;
-			i_max = float(window_width / grid_square_size) - i_shift;
+		if (!candidates.empty() && occupancy_batch_client.call(occupancy_batch_srv))
+			occupancies = occupancy_batch_srv.response.occupancies;
 
-			for (float i = i_shift; i < i_max; i += .5)
-			{
-				x_grid = i0 + grid_square_size * (j * sin(theta) - i * cos(theta));
-				y_grid = j0 + grid_square_size * (j * cos(theta) + i * sin(theta));
-
-				add_exploration_cell = true;
-
-				// If not already explrored and within map 
-				if (exploration_grid.at<float>(sq(x_grid), sq(y_grid)) < 1.0 && withinMap(x_grid, y_grid))
-				{
-					float frontier_distance = distance(x, y, x_grid, y_grid);
-
-					// Check if in sight from robot
-					if (frontier_distance > .1)
-					{
-						x_ray = x;
-						y_ray = y;
-						x_diff = float(x_grid - x);
-						y_diff = float(y_grid - y);
-						theta_diff = std::abs(std::fmod(theta - atan2(y_diff, x_diff) + pi, 2 * pi) - pi);
-						int n = 4 * std::max(std::abs(sq(x_diff)), std::abs(sq(y_diff)));
-
-						for (int i_ray = 0; i_ray < n; i_ray++)
-						{
-							x_ray += x_diff / n;
-							y_ray += y_diff / n;
-
-							if (wall_grid[sq(x_ray)][sq(y_ray)] == 1.0)
-							{
-								add_exploration_cell = false;
-								break;
-							}
-						}
-					}
-
-					if (add_exploration_cell)
-					{
-						// If at edge of camera field i.e. frontier
-						if (j > 10.0 && (j > j_max - 1.5 || i < i_shift + 1.0 || i > i_max - 1.5))
-						{
-
-							int number_unexplored = 0;
-
-							// Check explorability at frontier
-							for (int i_frontier = sq(x_grid) - frontier_window_size; i_frontier < sq(x_grid) + frontier_window_size; i_frontier++)
-							{
-								for (int j_frontier = sq(y_grid) - frontier_window_size; j_frontier < sq(y_grid) + frontier_window_size; j_frontier++)
-								{
-									if (exploration_grid.at<float>(i_frontier, j_frontier) == 0.0)
-									{
-										number_unexplored++;
-									}
-								}
-							}
-
-							occupancy_srv.request.x = x_grid;
-							occupancy_srv.request.y = y_grid;
-
-							// Add frontier if the space is sufficiently free
-							if (occupancy_client.call(occupancy_srv))
-							{
-								if (occupancy_srv.response.occupancy < .8)
-								{
-									frontier_ptr frontier_node = std::make_shared<Frontier>(x_grid, y_grid, occupancy_srv.response.occupancy, theta_diff, frontier_distance, number_unexplored);
-									frontier_nodes.push_back(frontier_node);
-									all_frontiers_nodes.push_back(frontier_node);
-									exploration_grid.at<float>(sq(x_grid), sq(y_grid)) = -1.0;
-								}
-							}
-						}
-						else
-							exploration_grid.at<float>(sq(x_grid), sq(y_grid)) = 1.0;
-					}
-				}
-			}
-		}
+		exploration_map.addFrontiers(occupancies);
 
 		grid_matrix_msg = publishExplorationGrid();
 
@@ -304,21 +125,12 @@ class MappingGridsServer
 		return res.success;
 	}
 
+	// Cheapest frontier cluster from the pose of the last exploreHere
 	bool getFrontier(robo7_srvs::getFrontier::Request &req, robo7_srvs::getFrontier::Response &res)
 	{
-		frontier_ptr frontier_destination_node;
+		const Frontier *frontier_destination_node = exploration_map.cheapestFrontier();
 
-
-		std::vector<frontier_ptr>::iterator min_cost_iterator;
-
-		if (!all_frontiers_nodes.empty())
-		{
-			min_cost_iterator = std::min_element(all_frontiers_nodes.begin(), all_frontiers_nodes.end(), [](const frontier_ptr a, const frontier_ptr b) {
-				return a->getCost() < b->getCost();
-			});
-			frontier_destination_node = all_frontiers_nodes[std::distance(all_frontiers_nodes.begin(), min_cost_iterator)];
-		}
-		else
+		if (frontier_destination_node == NULL)
 		{
 			ROS_INFO("Everything explored!");
 			res.success = true;
@@ -326,6 +138,7 @@ class MappingGridsServer
 
 			return res.success;
 		}
+
 		geometry_msgs::Twist frontier_destination_pose;
 
 		frontier_destination_pose.linear.x = frontier_destination_node->x;
@@ -370,9 +183,10 @@ class MappingGridsServer
 		ROS_DEBUG("Setting mapping grids size");
 
 		// Wait untill we get our first coordinates
-		while (X_wall_coordinates.size() <= 0)
+		while (X_wall_coordinates.size() <= 0 && ros::ok())
 		{
 			ros::spinOnce();
+			ros::Duration(0.01).sleep();
 		}
 
 		// Get maximum coordinates in grid
@@ -387,24 +201,84 @@ class MappingGridsServer
 		ROS_DEBUG("y squares: %d", num_grid_squares_y);
 
 		// Set up sizes
-		grid.resize(num_grid_squares_x);
-		wall_grid.resize(num_grid_squares_x);
+		grid.reset(num_grid_squares_x, num_grid_squares_y, grid_square_size);
+		wall_grid.reset(num_grid_squares_x, num_grid_squares_y, grid_square_size);
+		occupancy_grid.reset(num_grid_squares_x, num_grid_squares_y, grid_square_size);
+
+		ros::WallTime start_time = ros::WallTime::now();
+		uint64_t cache_key = gridCacheKey();
 
-		for (int i = 0; i < num_grid_squares_x; ++i)
+		if (loadCachedGrids(cache_key))
 		{
-			grid[i].resize(num_grid_squares_y);
-			wall_grid[i].resize(num_grid_squares_y);
+			ROS_INFO("Grids loaded from %s in %.1f ms", gridCachePath(cache_key).c_str(), 1000 * (ros::WallTime::now() - start_time).toSec());
+			return;
 		}
 
 		updateBasicGrid();
 		updateBasicWallGrid();
+
+		ROS_INFO("Grids built in %.1f ms", 1000 * (ros::WallTime::now() - start_time).toSec());
+
+		saveCachedGrids(cache_key);
 	}
 
-	float distance_points(int x, int y, int a, int b)
+	// The grids only depend on the walls and these parameters
+	uint64_t gridCacheKey()
 	{
-		float x_diff = x - a;
-		float y_diff = y - b;
-		return std::sqrt(x_diff * x_diff + y_diff * y_diff);
+		std::vector<double> parameters = {grid_square_size, min_distance, wall_thickness, double(smoothing_kernel_size), double(smoothing_kernel_sd)};
+
+		return heuristic_grids::gridCacheKey(X_wall_coordinates, Y_wall_coordinates, parameters);
+	}
+
+	std::string gridCachePath(uint64_t key)
+	{
+		return heuristic_grids::gridCachePath(grid_cache_directory, "mapping_grids_server", key);
+	}
+
+	// Inflated, wall and blurred grids of an earlier start on the same map
+	bool loadCachedGrids(uint64_t key)
+	{
+		heuristic_grids::CachedGrids cached;
+
+		if (!use_grid_cache || !heuristic_grids::loadGridCache(gridCachePath(key), key, cached))
+			return false;
+
+		if (cached.layers.size() != 3 || cached.num_grid_squares_x != num_grid_squares_x || cached.num_grid_squares_y != num_grid_squares_y)
+			return false;
+
+		grid = cached.layers[0];
+		wall_grid = cached.layers[1];
+		occupancy_grid = cached.layers[2];
+
+		return true;
+	}
+
+	void saveCachedGrids(uint64_t key)
+	{
+		if (!use_grid_cache)
+			return;
+
+		heuristic_grids::CachedGrids cached;
+		cached.num_grid_squares_x = num_grid_squares_x;
+		cached.num_grid_squares_y = num_grid_squares_y;
+		cached.grid_square_size = grid_square_size;
+		cached.layers.push_back(grid);
+		cached.layers.push_back(wall_grid);
+		cached.layers.push_back(occupancy_grid);
+
+		if (!heuristic_grids::saveGridCache(gridCachePath(key), key, cached))
+			ROS_WARN("Could not save the grids to %s", gridCachePath(key).c_str());
+	}
+
+	// Sets 1.0 for the inflated walls of the wall points in grid_instant
+	void inflateWalls(int num_squares, heuristic_grids::Grid2D<float> &grid_instant)
+	{
+		heuristic_grids::WallInflation inflation;
+		inflation.reset(num_grid_squares_x, num_grid_squares_y, grid_square_size, num_squares);
+		inflation.addPoints(X_wall_coordinates, Y_wall_coordinates);
+
+		cv::Mat grid_view = heuristic_grids::matView(grid_instant);
+		heuristic_grids::matView(inflation.walls()).convertTo(grid_view, CV_32F);
 	}
 
 	float distance(float x, float y, float x_to, float y_to)
@@ -415,13 +289,11 @@ class MappingGridsServer
 
 		if (distance_grid_init)
 		{
-			return float(distance_grid.at<int>(sq(x), sq(y))) * grid_square_size;
+			return float(distance_field.distance(sq(x), sq(y))) * grid_square_size;
 		}
 		else
 		{
-			distance_grid = cv::Mat::zeros(num_grid_squares_x, num_grid_squares_y, CV_32SC1);
-
-			if (!setDistance(sq(x_to), sq(y_to), 0))
+			if (!setDistance(sq(x_to), sq(y_to)))
 			{
 				ROS_WARN("No distance grid was generated for x:%f, y:%f", x_to, y_to);
 				return 0;
@@ -430,8 +302,8 @@ class MappingGridsServer
 			{
 				distance_grid_init = true;
 
-				ROS_INFO("Distance %f", float(distance_grid.at<int>(sq(x), sq(y))) * grid_square_size);
-				return float(distance_grid.at<int>(sq(x), sq(y))) * grid_square_size;
+				ROS_INFO("Distance %f", float(distance_field.distance(sq(x), sq(y))) * grid_square_size);
+				return float(distance_field.distance(sq(x), sq(y))) * grid_square_size;
 			}
 			/*
 		else
@@ -444,161 +316,51 @@ class MappingGridsServer
 		}
 	}
 
-	bool setDistance(int x, int y, int dist)
+	// Breadth first wavefront from the goal square through the walls, each
+	// square is set once
+	bool setDistance(int goal_i, int goal_j)
 	{
-		if (x >= 0 && y >= 0 && x < num_grid_squares_x && y < num_grid_squares_y)
-		{
-			if (wall_grid[x][y] >= 1)
-			{
-				return false;
-			}
-			else
-			{
-				if (distance_grid.at<int>(x, y) > dist || distance_grid.at<int>(x, y) == 0)
-				{
-
-					distance_grid.at<int>(x, y) = dist;
-
-					int x_pos = x + 1;
-					int y_pos = y + 1;
-					int x_neg = x - 1;
-					int y_neg = y - 1;
-
-					if (x_pos < num_grid_squares_x)
-					{
-						setDistance(x_pos, y, dist + 1);
-					}
-					if (x_neg >= 0)
-					{
-						setDistance(x_neg, y, dist + 1);
-					}
-					if (y_pos < num_grid_squares_y)
-					{
-						setDistance(x, y_pos, dist + 1);
-					}
-					if (y_neg >= 0)
-					{
-						setDistance(x, y_neg, dist + 1);
-					}
-				}
-				return true;
-			}
-		}
-		else
-		{
-			ROS_WARN("Outside of bounds, x:%d, y:%d, numsqx:%d, numsqy:%d", x, y, num_grid_squares_x, num_grid_squares_y);
-			return false;
-		}
+		heuristic_grids::Grid2D<uint8_t> wall_squares(num_grid_squares_x, num_grid_squares_y, grid_square_size);
+		cv::Mat wall_squares_view = heuristic_grids::matView(wall_squares);
+		heuristic_grids::matView(wall_grid).convertTo(wall_squares_view, CV_8U);
+
+		heuristic_grids::GridSnapshot walls;
+		walls.version = 1;
+		walls.reset(num_grid_squares_x, num_grid_squares_y, grid_square_size);
+		walls.walls.assign(wall_squares);
+
+		return distance_field.compute(walls, goal_i, goal_j);
 	}
 
 	void updateBasicGrid()
 	{
 		ROS_DEBUG("Updating occupancy grid");
 
-		// Put every point in the grid
-		for (int i = 0; i < X_wall_coordinates.size(); ++i)
-		{
-			// Get the square that the point is located in
-			int square_x = sq(X_wall_coordinates[i]);
-			int square_y = sq(Y_wall_coordinates[i]);
-
-			int x_low = square_x - num_min_distance_squares;
-			int y_low = square_y - num_min_distance_squares;
-
-			int x_high = square_x + num_min_distance_squares;
-			int y_high = square_y + num_min_distance_squares;
-
-			// Setting 1.0 for all the walls (enlarged by the min distance)
-			for (int i = x_low; i <= x_high; ++i)
-			{
-				for (int j = y_low; j <= y_high; ++j)
-				{
-					if (!(i < 0) && !(i >= num_grid_squares_x) && !(j < 0) && !(j >= num_grid_squares_y))
-					{
-						// This keeps the wall expansion radial
-						if (distance_points(square_x, square_y, i, j) <= (num_min_distance_squares))
-						{
-							grid[i][j] = 1.0;
-						}
-					}
-				}
-			}
-		}
-
-		// Setting the filtered grid
-
-		cv::Mat basic_grid(grid.size(), grid.at(0).size(), CV_64FC1);
-
-		for (int i = 0; i < basic_grid.rows; ++i)
-		{
-			for (int j = 0; j < basic_grid.cols; ++j)
-			{
-				basic_grid.at<float>(i, j) = grid[i][j];
-			}
-		}
+		// Setting 1.0 for all the walls (enlarged by the min distance)
+		inflateWalls(num_min_distance_squares, grid);
 
-		occupancy_grid = gaussFilter(basic_grid, smoothing_kernel_size, smoothing_kernel_sd);
+		// Setting the filtered grid, blurred straight from the wall cells
+		gaussFilter(grid, occupancy_grid, smoothing_kernel_size, smoothing_kernel_sd);
 	}
 
 	void updateBasicWallGrid()
 	{
 		ROS_DEBUG("Updating wall occupancy grid");
 
-		// Put every point in the grid
-		for (int i = 0; i < X_wall_coordinates.size(); ++i)
-		{
-			// Get the square that the point is located in
-			int square_x = sq(X_wall_coordinates[i]);
-			int square_y = sq(Y_wall_coordinates[i]);
-
-			int x_low = square_x - num_wall_thickness_squares;
-			int y_low = square_y - num_wall_thickness_squares;
-
-			int x_high = square_x + num_wall_thickness_squares;
-			int y_high = square_y + num_wall_thickness_squares;
-
-			// Setting 1.0 for all the walls (enlarged by the min distance)
-			for (int i = x_low; i <= x_high; ++i)
-			{
-				for (int j = y_low; j <= y_high; ++j)
-				{
-					if (!(i < 0) && !(i >= num_grid_squares_x) && !(j < 0) && !(j >= num_grid_squares_y))
-					{
-						// This keeps the wall expansion radial
-						if (distance_points(square_x, square_y, i, j) <= (num_wall_thickness_squares))
-						{
-							wall_grid[i][j] = 1.0;
-						}
-					}
-				}
-			}
-		}
+		inflateWalls(num_wall_thickness_squares, wall_grid);
 	}
 
-	cv::Mat gaussFilter(cv::Mat grid_in, int kernel_size, int sigma)
+	// Blurs grid_in into grid_out, normalised to [0, 1] with the walls of
+	// grid_in at 1
+	void gaussFilter(const heuristic_grids::Grid2D<float> &grid_in, heuristic_grids::Grid2D<float> &grid_out, int kernel_size, int sigma)
 	{
-		cv::Mat grid_filtered;
+		cv::Mat grid_filtered = heuristic_grids::matView(grid_out);
 
-		GaussianBlur(grid_in, grid_filtered, cv::Size(kernel_size, kernel_size), sigma, 0);
-
-		cv::Mat normalized_grid;
-		cv::normalize(grid_filtered, normalized_grid, 0, 1, cv::NORM_MINMAX, CV_32F);
-
-		cv::Mat normalized_grid_ones = normalized_grid.clone();
-
-		for (int i = 0; i < normalized_grid.rows; ++i)
-		{
-			for (int j = 0; j < normalized_grid.cols; ++j)
-			{
-				if (grid[i][j] >= 1)
-				{
-					normalized_grid_ones.at<float>(i, j) = 1;
-				}
-			}
-		}
+		GaussianBlur(heuristic_grids::matView(grid_in), grid_filtered, cv::Size(kernel_size, kernel_size), sigma, 0);
+		cv::normalize(grid_filtered, grid_filtered, 0, 1, cv::NORM_MINMAX);
+		grid_filtered.setTo(1, heuristic_grids::matView(grid_in) >= 1);
 
 		ROS_INFO("Gaussed grid ready");
-		return normalized_grid_ones;
 	}
 	robo7_msgs::grid_matrix publishOccupancyGrid()
 	{
@@ -607,13 +369,9 @@ class MappingGridsServer
 
 		std::vector<float> grid_row;
 
-		for (int i = 0; i < occupancy_grid.rows; i++)
+		for (int i = 0; i < occupancy_grid.numGridSquaresX(); i++)
 		{
-			grid_row.clear();
-			for (int j = 0; j < occupancy_grid.cols; j++)
-			{
-				grid_row.push_back(occupancy_grid.at<float>(i, j));
-			}
+			grid_row.assign(occupancy_grid.row(i), occupancy_grid.row(i) + occupancy_grid.numGridSquaresY());
 			grid_row_msg.grid_row = grid_row;
 			grid_matrix_msg.grid_rows.push_back(grid_row_msg);
 		}
@@ -629,13 +387,9 @@ class MappingGridsServer
 
 		std::vector<float> grid_row;
 
-		for (int i = 0; i < wall_grid.size(); i++)
+		for (int i = 0; i < wall_grid.numGridSquaresX(); i++)
 		{
-			grid_row.clear();
-			for (int j = 0; j < wall_grid[i].size(); j++)
-			{
-				grid_row.push_back((float)wall_grid[i][j]);
-			}
+			grid_row.assign(wall_grid.row(i), wall_grid.row(i) + wall_grid.numGridSquaresY());
 			grid_row_msg.grid_row = grid_row;
 			grid_matrix_msg.grid_rows.push_back(grid_row_msg);
 		}
@@ -650,13 +404,11 @@ class MappingGridsServer
 
 		std::vector<float> exploration_row;
 
-		for (int i = 0; i < exploration_grid.rows; i++)
+		const heuristic_grids::Grid2D<float> &exploration_grid = exploration_map.explorationGrid();
+
+		for (int i = 0; i < exploration_grid.numGridSquaresX(); i++)
 		{
-			exploration_row.clear();
-			for (int j = 0; j < exploration_grid.cols; j++)
-			{
-				exploration_row.push_back(exploration_grid.at<float>(i, j));
-			}
+			exploration_row.assign(exploration_grid.row(i), exploration_grid.row(i) + exploration_grid.numGridSquaresY());
 			exploration_row_msg.grid_row = exploration_row;
 			exploration_matrix_msg.grid_rows.push_back(exploration_row_msg);
 		}
@@ -670,14 +422,14 @@ class MappingGridsServer
 	float grid_square_size;
 	int smoothing_kernel_size;
 	int smoothing_kernel_sd;
+	bool use_grid_cache;
+	std::string grid_cache_directory;
 	int num_grid_squares_x;
 	int num_grid_squares_y;
 	std::vector<float> X_wall_coordinates;
 	std::vector<float> Y_wall_coordinates;
-	cv::Mat occupancy_grid;
-	cv::Mat basic_grid;
-	cv::Mat exploration_grid;
-	cv::Mat distance_grid;
+	heuristic_grids::Grid2D<float> occupancy_grid;
+	heuristic_grids::DistanceField distance_field;
 	float current_x_to, current_y_to;
 	bool occupancy_grid_init, exploration_grid_init, distance_grid_init;
 };
@@ -0,0 +1,47 @@
+#include "exploration/summed_area_table.h"
+
+SummedAreaTable::SummedAreaTable()
+	: num_grid_squares_x(0), num_grid_squares_y(0), value(0)
+{
+}
+
+void SummedAreaTable::build(const heuristic_grids::Grid2D<float> &grid, float value)
+{
+	this->value = value;
+	num_grid_squares_x = grid.numGridSquaresX();
+	num_grid_squares_y = grid.numGridSquaresY();
+
+	// Row and column 0 stay 0
+	sums.assign(size_t(num_grid_squares_x + 1) * (num_grid_squares_y + 1), 0);
+
+	compute(grid, 0, 0);
+}
+
+void SummedAreaTable::update(const heuristic_grids::Grid2D<float> &grid, int i_min, int j_min, int i_max, int j_max)
+{
+	if (i_max < 0 || j_max < 0 || i_min >= num_grid_squares_x || j_min >= num_grid_squares_y)
+		return;
+
+	compute(grid, std::max(i_min, 0), std::max(j_min, 0));
+}
+
+void SummedAreaTable::compute(const heuristic_grids::Grid2D<float> &grid, int i_min, int j_min)
+{
+	size_t stride = num_grid_squares_y + 1;
+
+	for (int i = i_min; i < num_grid_squares_x; i++)
+	{
+		const float *row = grid.row(i);
+		int32_t *above = &sums[size_t(i) * stride];
+		int32_t *current = &sums[size_t(i + 1) * stride];
+
+		// Count of the row left of j_min, from the sums already there
+		int32_t row_count = current[j_min] - above[j_min];
+
+		for (int j = j_min; j < num_grid_squares_y; j++)
+		{
+			row_count += row[j] == value;
+			current[j + 1] = above[j + 1] + row_count;
+		}
+	}
+}
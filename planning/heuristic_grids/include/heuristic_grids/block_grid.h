@@ -0,0 +1,135 @@
+#ifndef HEURISTIC_GRIDS_BLOCK_GRID_H
+#define HEURISTIC_GRIDS_BLOCK_GRID_H
+
+#include <algorithm>
+#include <vector>
+#include "heuristic_grids/grid2d.h"
+#include "heuristic_grids/grid_traversal.h"
+#include "heuristic_grids/shared_grid.h"
+
+// Coarse level over a GridSnapshot. The grid is split into blocks of
+// block_size x block_size squares, each keeping the largest occupancy of its
+// squares, so queries can answer open parts of the map per block and only
+// look at single squares in the blocks near walls.
+
+namespace heuristic_grids
+{
+
+static const int DEFAULT_BLOCK_SIZE = 8;
+
+class BlockGrid
+{
+  public:
+	BlockGrid();
+
+	// Summarizes every block of the grid
+	void build(const GridSnapshot &grid, int block_size = DEFAULT_BLOCK_SIZE);
+
+	// Redoes the blocks holding squares [i_min, i_max] x [j_min, j_max], after
+	// they changed in a grid of the same size
+	void update(const GridSnapshot &grid, int i_min, int j_min, int i_max, int j_max);
+
+	bool empty() const
+	{
+		return max_occupancy.empty();
+	}
+
+	int blockSize() const
+	{
+		return block_size;
+	}
+
+	float gridSquareSize() const
+	{
+		return grid_square_size;
+	}
+
+	// Block holding square i (or j)
+	int block(int i) const
+	{
+		return i >= 0 ? i / block_size : -((block_size - 1 - i) / block_size);
+	}
+
+	// Largest occupancy of the squares in the block. Squares outside the
+	// grid count as 1, like in GridSnapshot::occupancyAtCell.
+	float blockOccupancy(int block_i, int block_j) const
+	{
+		return max_occupancy.at(block_i, block_j, 1);
+	}
+
+	// True if every square in [i_min, i_max] x [j_min, j_max] has occupancy 0.
+	// Answered from one block, false can also mean the area is too large to
+	// tell.
+	bool regionFree(int i_min, int j_min, int i_max, int j_max) const;
+
+  private:
+	void summarize(const GridSnapshot &grid, int block_i, int block_j);
+	void computeFreeRadius();
+
+	int block_size;
+	int num_blocks_x, num_blocks_y;
+	float grid_square_size;
+
+	Grid2D<float> max_occupancy;
+
+	// Chebyshev distance in blocks to the nearest block that is not free
+	// (or to outside the grid), 0 for those blocks
+	Grid2D<int> free_radius;
+};
+
+// Calls visit(i, j, enter, exit) for the squares from (x0, y0) to (x1, y1) in
+// the same order as traverseGrid, but skips every block whose occupancy is
+// below skip_below. enter and exit are the fractions of the segment inside
+// the square. Stops when visit returns false, true if the end was reached.
+// The walk restarts where the segment enters a block, so where it passes
+// within rounding of a square corner it may take the other square there.
+template <typename Visit>
+bool traverseBlocks(const BlockGrid &blocks, float x0, float y0, float x1, float y1, float skip_below, Visit visit)
+{
+	int block_size = blocks.blockSize();
+	GridTraversal block(x0, y0, x1, y1, block_size * blocks.gridSquareSize());
+	float enter = 0;
+
+	do
+	{
+		float exit = block.exit();
+
+		if (blocks.blockOccupancy(block.i(), block.j()) >= skip_below)
+		{
+			// Squares from where the segment enters the block until it leaves
+			int i_min = block.i() * block_size;
+			int j_min = block.j() * block_size;
+			GridTraversal square(x0 + enter * (x1 - x0), y0 + enter * (y1 - y0), x1, y1, blocks.gridSquareSize());
+			float square_enter = enter;
+			bool inside = false;
+
+			do
+			{
+				float square_exit = std::max(square_enter, enter + square.exit() * (1 - enter));
+
+				if (square.i() < i_min || square.j() < j_min || square.i() >= i_min + block_size || square.j() >= j_min + block_size)
+				{
+					// Rounding can start the walk one square early
+					if (inside || square_exit >= exit)
+						break;
+					continue;
+				}
+
+				inside = true;
+
+				if (!visit(square.i(), square.j(), square_enter, square_exit))
+					return false;
+
+				square_enter = square_exit;
+			} while (square.next());
+		}
+
+		enter = std::max(enter, exit);
+	} while (block.next());
+
+	return true;
+}
+
+}
+
+#endif
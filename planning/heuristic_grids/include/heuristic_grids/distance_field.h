@@ -0,0 +1,48 @@
+#ifndef HEURISTIC_GRIDS_DISTANCE_FIELD_H
+#define HEURISTIC_GRIDS_DISTANCE_FIELD_H
+
+#include <stdint.h>
+#include <vector>
+#include "heuristic_grids/grid2d.h"
+#include "heuristic_grids/shared_grid.h"
+
+namespace heuristic_grids
+{
+
+// Distance in grid squares from a goal cell to every cell reachable through
+// non-wall cells (4-connected), i.e. what /distance_grid/distance answers.
+class DistanceField
+{
+  public:
+	DistanceField();
+
+	// Breadth first wavefront from the goal. Returns false if the goal is
+	// outside the grid or inside a wall, then every distance is 0.
+	bool compute(const GridSnapshot &grid, int goal_i, int goal_j);
+
+	// Repairs the field after the walls of a few squares changed, given as
+	// indices into the grids. Only the squares whose distance depended on
+	// them are raised and lowered again. Falls back to compute() if the grid
+	// size changed or the goal became a wall.
+	bool update(const GridSnapshot &grid, const std::vector<int32_t> &changed_walls);
+
+	// 0 for unreachable cells, like the service
+	int distance(int i, int j) const;
+
+	bool matches(const GridSnapshot &grid, int goal_i, int goal_j) const;
+	bool matches(uint32_t grid_version, int goal_i, int goal_j) const;
+
+	// Bytes held by the distances
+	size_t memory() const;
+
+  private:
+	bool supported(const GridSnapshot &grid, int i, int j) const;
+
+	Grid2D<int32_t> field;
+	int goal_i, goal_j;
+	uint32_t grid_version;
+};
+
+}
+
+#endif
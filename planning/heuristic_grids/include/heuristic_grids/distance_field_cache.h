@@ -0,0 +1,50 @@
+#ifndef HEURISTIC_GRIDS_DISTANCE_FIELD_CACHE_H
+#define HEURISTIC_GRIDS_DISTANCE_FIELD_CACHE_H
+
+#include <stddef.h>
+#include <list>
+#include "heuristic_grids/distance_field.h"
+
+namespace heuristic_grids
+{
+
+// Least recently used distance fields by goal square, so callers that take
+// turns with different goals do not rebuild the wavefront on every request.
+// Fields belong to one grid version and are dropped once the grids change.
+class DistanceFieldCache
+{
+  public:
+	// At most max_fields fields and, if memory_budget is not 0, at most that
+	// many bytes. The last field asked for is always kept.
+	explicit DistanceFieldCache(size_t max_fields = 8, size_t memory_budget = 0);
+
+	void configure(size_t max_fields, size_t memory_budget);
+
+	// Field for the goal on the grids, computed if not cached. NULL if the
+	// goal is outside the grid or inside a wall.
+	const DistanceField *get(const GridSnapshot &grid, int goal_i, int goal_j);
+
+	void clear();
+
+	size_t size() const;
+	size_t memory() const;
+
+	unsigned long hits, misses;
+
+  private:
+	struct Entry
+	{
+		int goal_i, goal_j;
+		DistanceField field;
+	};
+
+	void evict();
+
+	std::list<Entry> entries;
+	uint32_t grid_version;
+	size_t max_fields, memory_budget;
+};
+
+}
+
+#endif
@@ -0,0 +1,233 @@
+#ifndef HEURISTIC_GRIDS_GRID2D_H
+#define HEURISTIC_GRIDS_GRID2D_H
+
+#include <math.h>
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+// One contiguous grid of cells for the grid based nodes, instead of nested
+// vectors, cv::Mats and message rows. Cells are stored x-major, cell (i, j)
+// with i along x at index i * num_grid_squares_y + j, the layout of
+// GridSnapshot and of cv::Mat(num_grid_squares_x, num_grid_squares_y), so
+// the grid can be handed to OpenCV without a copy (see grid2d_mat.h).
+
+namespace heuristic_grids
+{
+
+// Cells start on a cache line
+static const size_t GRID_ALIGNMENT = 64;
+
+template <typename T>
+struct AlignedAllocator
+{
+	typedef T value_type;
+
+	AlignedAllocator()
+	{
+	}
+
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U> &)
+	{
+	}
+
+	T *allocate(size_t n)
+	{
+		void *memory = NULL;
+		if (posix_memalign(&memory, GRID_ALIGNMENT, n * sizeof(T)) != 0)
+			throw std::bad_alloc();
+
+		return static_cast<T *>(memory);
+	}
+
+	void deallocate(T *memory, size_t)
+	{
+		free(memory);
+	}
+
+	template <typename U>
+	struct rebind
+	{
+		typedef AlignedAllocator<U> other;
+	};
+};
+
+template <typename T, typename U>
+bool operator==(const AlignedAllocator<T> &, const AlignedAllocator<U> &)
+{
+	return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const AlignedAllocator<T> &, const AlignedAllocator<U> &)
+{
+	return false;
+}
+
+template <typename T>
+class Grid2D
+{
+  public:
+	Grid2D()
+		: num_grid_squares_x(0), num_grid_squares_y(0), grid_square_size(1), origin_x(0), origin_y(0)
+	{
+	}
+
+	Grid2D(int num_grid_squares_x, int num_grid_squares_y, float grid_square_size, T value = T())
+	{
+		reset(num_grid_squares_x, num_grid_squares_y, grid_square_size, value);
+	}
+
+	// Resizes and sets every cell to value. (origin_x, origin_y) is the
+	// corner of cell (0, 0) in the world.
+	void reset(int num_grid_squares_x, int num_grid_squares_y, float grid_square_size, T value = T(),
+			   float origin_x = 0, float origin_y = 0)
+	{
+		this->num_grid_squares_x = num_grid_squares_x > 0 ? num_grid_squares_x : 0;
+		this->num_grid_squares_y = num_grid_squares_y > 0 ? num_grid_squares_y : 0;
+		this->grid_square_size = grid_square_size;
+		this->origin_x = origin_x;
+		this->origin_y = origin_y;
+
+		cells.assign(size_t(this->num_grid_squares_x) * this->num_grid_squares_y, value);
+	}
+
+	void fill(T value)
+	{
+		cells.assign(cells.size(), value);
+	}
+
+	bool empty() const
+	{
+		return cells.empty();
+	}
+
+	size_t size() const
+	{
+		return cells.size();
+	}
+
+	int numGridSquaresX() const
+	{
+		return num_grid_squares_x;
+	}
+
+	int numGridSquaresY() const
+	{
+		return num_grid_squares_y;
+	}
+
+	float gridSquareSize() const
+	{
+		return grid_square_size;
+	}
+
+	// World to cell, floor like GridSnapshot::sq
+	int cellX(float x) const
+	{
+		return floor((x - origin_x) / grid_square_size);
+	}
+
+	int cellY(float y) const
+	{
+		return floor((y - origin_y) / grid_square_size);
+	}
+
+	// Cell to world, the center of the cell
+	float worldX(int i) const
+	{
+		return origin_x + (i + 0.5f) * grid_square_size;
+	}
+
+	float worldY(int j) const
+	{
+		return origin_y + (j + 0.5f) * grid_square_size;
+	}
+
+	bool withinGrid(int i, int j) const
+	{
+		return i >= 0 && j >= 0 && i < num_grid_squares_x && j < num_grid_squares_y;
+	}
+
+	size_t index(int i, int j) const
+	{
+		return size_t(i) * num_grid_squares_y + j;
+	}
+
+	// Unchecked
+	T &operator()(int i, int j)
+	{
+		return cells[index(i, j)];
+	}
+
+	const T &operator()(int i, int j) const
+	{
+		return cells[index(i, j)];
+	}
+
+	// Unchecked, by index(i, j)
+	T &operator[](size_t k)
+	{
+		return cells[k];
+	}
+
+	const T &operator[](size_t k) const
+	{
+		return cells[k];
+	}
+
+	// The num_grid_squares_y cells with the same i
+	T *row(int i)
+	{
+		return &cells[index(i, 0)];
+	}
+
+	const T *row(int i) const
+	{
+		return &cells[index(i, 0)];
+	}
+
+	// Checked, outside is returned for cells outside the grid
+	T at(int i, int j, T outside) const
+	{
+		return withinGrid(i, j) ? cells[index(i, j)] : outside;
+	}
+
+	T atWorld(float x, float y, T outside) const
+	{
+		return at(cellX(x), cellY(y), outside);
+	}
+
+	// Checked, false for cells outside the grid
+	bool set(int i, int j, T value)
+	{
+		if (!withinGrid(i, j))
+			return false;
+
+		cells[index(i, j)] = value;
+		return true;
+	}
+
+	T *data()
+	{
+		return cells.empty() ? NULL : &cells[0];
+	}
+
+	const T *data() const
+	{
+		return cells.empty() ? NULL : &cells[0];
+	}
+
+  private:
+	int num_grid_squares_x, num_grid_squares_y;
+	float grid_square_size;
+	float origin_x, origin_y;
+	std::vector<T, AlignedAllocator<T> > cells;
+};
+
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef HEURISTIC_GRIDS_GRID2D_MAT_H
+#define HEURISTIC_GRIDS_GRID2D_MAT_H
+
+#include <opencv2/core/core.hpp>
+#include "heuristic_grids/grid2d.h"
+
+// cv::Mat views of a Grid2D, sharing its cells. A view is only valid until the
+// grid is reset.
+
+namespace heuristic_grids
+{
+
+template <typename T>
+cv::Mat matView(Grid2D<T> &grid)
+{
+	return cv::Mat(grid.numGridSquaresX(), grid.numGridSquaresY(), cv::DataType<T>::type, grid.data());
+}
+
+// Read only by convention, cv::Mat has no const view
+template <typename T>
+const cv::Mat matView(const Grid2D<T> &grid)
+{
+	return cv::Mat(grid.numGridSquaresX(), grid.numGridSquaresY(), cv::DataType<T>::type, const_cast<T *>(grid.data()));
+}
+
+}
+
+#endif
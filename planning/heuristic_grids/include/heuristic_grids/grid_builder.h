@@ -0,0 +1,33 @@
+#ifndef HEURISTIC_GRIDS_GRID_BUILDER_H
+#define HEURISTIC_GRIDS_GRID_BUILDER_H
+
+#include <vector>
+#include "heuristic_grids/shared_grid.h"
+
+// Builds the heuristic grids from wall points without a ROS master, for
+// offline tools. Follows heuristic_grids_server: walls inflated by
+// min_distance, Gaussian blur, min-max normalization, walls set back to 1.
+
+namespace heuristic_grids
+{
+
+struct GridParameters
+{
+	float grid_square_size;
+	float min_distance;
+	int smoothing_kernel_size;
+	int smoothing_kernel_sd;
+
+	// Values from kinematics.launch
+	GridParameters()
+		: grid_square_size(0.02), min_distance(0.13), smoothing_kernel_size(21), smoothing_kernel_sd(7)
+	{
+	}
+};
+
+bool buildGrids(const std::vector<float> &X_wall_coordinates, const std::vector<float> &Y_wall_coordinates,
+				const GridParameters &parameters, GridSnapshot &grid);
+
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef HEURISTIC_GRIDS_GRID_CACHE_H
+#define HEURISTIC_GRIDS_GRID_CACHE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "heuristic_grids/grid2d.h"
+
+// Precomputed grids on disk, so a warm start maps the grids of a known map
+// instead of inflating and blurring them again.
+//
+// A cache file holds a header and float layers of num_grid_squares_x *
+// num_grid_squares_y cells, x-major like Grid2D, each starting on a 64 byte
+// boundary so the file can be mapped and read in place. Files are named by a
+// key hashing the wall points and the parameters the grids were built with.
+
+namespace heuristic_grids
+{
+
+static const int GRID_CACHE_MAX_VALUES = 8;
+
+struct CachedGrids
+{
+	CachedGrids();
+
+	int num_grid_squares_x, num_grid_squares_y;
+	float grid_square_size;
+
+	// Scalars the grids were built with besides the key, e.g. a blur scale
+	std::vector<double> values;
+	std::vector<Grid2D<float> > layers;
+};
+
+// FNV-1a over the wall points and the parameters
+uint64_t gridCacheKey(const std::vector<float> &X_wall_coordinates, const std::vector<float> &Y_wall_coordinates,
+					  const std::vector<double> &parameters);
+
+// $ROS_HOME/heuristic_grids, or ~/.ros/heuristic_grids
+std::string defaultGridCacheDirectory();
+
+// <directory>/<name>_<key in hex>.grids
+std::string gridCachePath(const std::string &directory, const std::string &name, uint64_t key);
+
+// Written next to the path and renamed into place, so readers never see a
+// partial file. The directory is created if missing.
+bool saveGridCache(const std::string &path, uint64_t key, const CachedGrids &grids);
+
+// False if there is no file for the key or it does not match
+bool loadGridCache(const std::string &path, uint64_t key, CachedGrids &grids);
+
+}
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef HEURISTIC_GRIDS_GRID_ENCODING_H
+#define HEURISTIC_GRIDS_GRID_ENCODING_H
+
+#include <stdint.h>
+
+// Cell encodings of the compact grid messages (robo7_msgs/compact_grid), one
+// or two bytes per cell instead of a float in a nested row message.
+
+namespace heuristic_grids
+{
+
+enum GridEncoding
+{
+	// value = offset + scale * byte
+	GRID_ENCODING_UINT8 = 0,
+	// IEEE half float, little endian, offset and scale unused
+	GRID_ENCODING_FLOAT16 = 1
+};
+
+int bytesPerCell(int encoding);
+
+// Writes bytesPerCell(encoding) bytes at cell. uint8 values are rounded to
+// the nearest step and clamped to 0..255.
+void encodeCell(float value, int encoding, float offset, float scale, uint8_t *cell);
+
+float decodeCell(const uint8_t *cell, int encoding, float offset, float scale);
+
+// Round to nearest even, too large values become infinity
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t half);
+
+}
+
+#endif
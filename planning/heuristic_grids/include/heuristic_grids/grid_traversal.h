@@ -0,0 +1,168 @@
+#ifndef HEURISTIC_GRIDS_GRID_TRAVERSAL_H
+#define HEURISTIC_GRIDS_GRID_TRAVERSAL_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+// Exact traversal of the grid squares a segment crosses (Amanatides and Woo),
+// for line of sight checks. Every square is visited once, in order from the
+// start to the end of the segment, with the same floor(coord / size) squares
+// as GridSnapshot::sq.
+
+namespace heuristic_grids
+{
+
+// Start of one or more rays, in grid squares
+struct GridRayOrigin
+{
+	int i, j;
+
+	// Position inside the start square, in [0, 1)
+	float u, v;
+
+	GridRayOrigin(float x0, float y0, float grid_square_size)
+	{
+		float x = x0 / grid_square_size;
+		float y = y0 / grid_square_size;
+
+		i = floor(x);
+		j = floor(y);
+		u = x - i;
+		v = y - j;
+	}
+};
+
+class GridTraversal
+{
+  public:
+	GridTraversal(float x0, float y0, float x1, float y1, float grid_square_size)
+	{
+		GridRayOrigin origin(x0, y0, grid_square_size);
+		start(origin, x0, y0, x1, y1, grid_square_size);
+	}
+
+	GridTraversal(const GridRayOrigin &origin, float x0, float y0, float x1, float y1, float grid_square_size)
+	{
+		start(origin, x0, y0, x1, y1, grid_square_size);
+	}
+
+	// Current square
+	int i() const
+	{
+		return cell_i;
+	}
+
+	int j() const
+	{
+		return cell_j;
+	}
+
+	// Fraction of the segment at which it leaves the current square, 1 in
+	// the end square
+	float exit() const
+	{
+		if (remaining == 0)
+			return 1;
+
+		return fminf(fminf(t_max_x, t_max_y), 1);
+	}
+
+	// Moves to the next square, false once the end square was visited
+	bool next()
+	{
+		if (remaining == 0)
+			return false;
+
+		// The step count is exact, rounding only decides the order near the end
+		if (cell_j == end_j || (cell_i != end_i && t_max_x < t_max_y))
+		{
+			cell_i += step_i;
+			t_max_x += t_delta_x;
+		}
+		else
+		{
+			cell_j += step_j;
+			t_max_y += t_delta_y;
+		}
+
+		remaining--;
+		return true;
+	}
+
+  private:
+	void start(const GridRayOrigin &origin, float x0, float y0, float x1, float y1, float grid_square_size)
+	{
+		float dx = (x1 - x0) / grid_square_size;
+		float dy = (y1 - y0) / grid_square_size;
+
+		cell_i = origin.i;
+		cell_j = origin.j;
+		end_i = floor(x1 / grid_square_size);
+		end_j = floor(y1 / grid_square_size);
+
+		step_i = dx > 0 ? 1 : (dx < 0 ? -1 : 0);
+		step_j = dy > 0 ? 1 : (dy < 0 ? -1 : 0);
+
+		// Fraction of the segment between two x (y) square borders, and to
+		// the first one
+		t_delta_x = step_i != 0 ? 1 / fabs(dx) : INFINITY;
+		t_delta_y = step_j != 0 ? 1 / fabs(dy) : INFINITY;
+		t_max_x = step_i > 0 ? (1 - origin.u) * t_delta_x : (step_i < 0 ? origin.u * t_delta_x : INFINITY);
+		t_max_y = step_j > 0 ? (1 - origin.v) * t_delta_y : (step_j < 0 ? origin.v * t_delta_y : INFINITY);
+
+		remaining = abs(end_i - cell_i) + abs(end_j - cell_j);
+	}
+
+	int cell_i, cell_j, end_i, end_j;
+	int step_i, step_j;
+	float t_max_x, t_max_y, t_delta_x, t_delta_y;
+	int remaining;
+};
+
+// Calls visit(i, j) for every square from (x0, y0) to (x1, y1) until it
+// returns false. True if the end square was reached.
+template <typename Visit>
+bool traverseGrid(float x0, float y0, float x1, float y1, float grid_square_size, Visit visit)
+{
+	GridTraversal ray(x0, y0, x1, y1, grid_square_size);
+
+	do
+	{
+		if (!visit(ray.i(), ray.j()))
+			return false;
+	} while (ray.next());
+
+	return true;
+}
+
+// Same for many rays from one origin, e.g. the squares in a camera field seen
+// from the robot. Calls visit(ray, i, j) and sets reached[ray] to 1 for the
+// rays that got to their end square.
+template <typename Visit>
+void traverseGridRays(float x0, float y0, const std::vector<float> &x1, const std::vector<float> &y1, float grid_square_size, Visit visit, std::vector<uint8_t> &reached)
+{
+	GridRayOrigin origin(x0, y0, grid_square_size);
+
+	reached.assign(x1.size(), 1);
+
+	for (size_t ray = 0; ray < x1.size(); ray++)
+	{
+		GridTraversal traversal(origin, x0, y0, x1[ray], y1[ray], grid_square_size);
+
+		do
+		{
+			if (!visit(ray, traversal.i(), traversal.j()))
+			{
+				reached[ray] = 0;
+				break;
+			}
+		} while (traversal.next());
+	}
+}
+
+}
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef HEURISTIC_GRIDS_MAZE_MAP_H
+#define HEURISTIC_GRIDS_MAZE_MAP_H
+
+#include <string>
+#include <vector>
+
+// Maze files from ras_maze_map/maps, one wall "x1 y1 x2 y2" [m] per line,
+// '#' starts a comment line.
+
+namespace heuristic_grids
+{
+
+struct WallSegment
+{
+	float x1, y1, x2, y2;
+};
+
+bool loadMazeFile(const std::string &map_file, std::vector<WallSegment> &walls);
+
+// The wall points own_map publishes on /own_map/wall_coordinates: every wall
+// sampled every discretization_step [m], after a leading (0, 0) point.
+void discretizeWalls(const std::vector<WallSegment> &walls, float discretization_step,
+					 std::vector<float> &X_wall_coordinates, std::vector<float> &Y_wall_coordinates);
+
+}
+
+#endif
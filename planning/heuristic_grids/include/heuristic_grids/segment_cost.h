@@ -0,0 +1,35 @@
+#ifndef HEURISTIC_GRIDS_SEGMENT_COST_H
+#define HEURISTIC_GRIDS_SEGMENT_COST_H
+
+#include <vector>
+#include "heuristic_grids/block_grid.h"
+#include "heuristic_grids/shared_grid.h"
+
+namespace heuristic_grids
+{
+
+struct SegmentCost
+{
+	float max_occupancy;
+	// Occupancy times the length inside each square crossed [m]
+	float integral_occupancy;
+	float length;
+
+	SegmentCost()
+		: max_occupancy(0), integral_occupancy(0), length(0)
+	{
+	}
+};
+
+// Occupancy along the polyline through the corners (x[k], y[k]), over every
+// square it crosses (see grid_traversal.h). Squares outside the grid count as
+// 1. False with fewer than two corners.
+bool segmentCost(const GridSnapshot &grid, const std::vector<float> &x, const std::vector<float> &y, SegmentCost &cost);
+
+// Same cost, stepping over the blocks with occupancy 0 instead of walking
+// their squares. The blocks have to summarize the grid.
+bool segmentCost(const GridSnapshot &grid, const BlockGrid &blocks, const std::vector<float> &x, const std::vector<float> &y, SegmentCost &cost);
+
+}
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef HEURISTIC_GRIDS_SHARED_GRID_H
+#define HEURISTIC_GRIDS_SHARED_GRID_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "heuristic_grids/tiled_grid.h"
+
+// Shared memory snapshot of the heuristic grids.
+//
+// heuristic_grids_server writes the blurred occupancy grid and the inflated
+// wall grid into a POSIX shared memory segment every time they change. Nodes
+// running on the same machine attach to the segment and copy the latest
+// version into a GridSnapshot, so occupancy and distance lookups become plain
+// array reads instead of one service call per sample.
+
+namespace heuristic_grids
+{
+
+static const char *const DEFAULT_SHARED_GRID_NAME = "/robo7_heuristic_grids";
+
+// Local copy of the grids. Cells are stored x-major like every Grid2D, i.e.
+// cell (i, j) with i along x is at index i * num_grid_squares_y + j. Copies
+// share the tiles neither of them wrote into.
+struct GridSnapshot
+{
+	uint32_t version;
+	int num_grid_squares_x;
+	int num_grid_squares_y;
+	float grid_square_size;
+	TiledGrid<float> occupancy;
+	TiledGrid<uint8_t> walls;
+
+	GridSnapshot();
+
+	// Sizes both grids, every square free
+	void reset(int num_grid_squares_x, int num_grid_squares_y, float grid_square_size);
+
+	bool empty() const;
+	int sq(float coord) const;
+	bool withinGrid(int i, int j) const;
+	size_t index(int i, int j) const;
+
+	// Same answer as the /occupancy_grid/is_occupied service
+	float occupancyAt(float x, float y) const;
+	float occupancyAtCell(int i, int j) const;
+	bool isWall(int i, int j) const;
+};
+
+class SharedGridWriter
+{
+  public:
+	explicit SharedGridWriter(const std::string &name = DEFAULT_SHARED_GRID_NAME);
+	~SharedGridWriter();
+
+	// Copies the grids into the segment and bumps the version. The segment is
+	// created (or grown) on first use.
+	bool publish(const GridSnapshot &grids);
+
+	// Same, but only rows i_min to i_max changed since the last publish. The
+	// other rows are only copied if the segment does not hold that publish.
+	bool publish(const GridSnapshot &grids, int i_min, int i_max);
+
+	uint32_t version() const;
+
+  private:
+	size_t capacity() const;
+	bool reserve(size_t cells);
+	void unmap();
+
+	std::string name;
+	int fd;
+	void *mapping;
+	size_t mapping_size;
+	uint32_t current_version;
+
+	// Version of the last publish of this writer, 0 before the first
+	uint32_t published_version;
+};
+
+class SharedGridReader
+{
+  public:
+	explicit SharedGridReader(const std::string &name = DEFAULT_SHARED_GRID_NAME);
+	~SharedGridReader();
+
+	// Refreshes the snapshot if the writer published a newer version. While
+	// the writer copies rows it yields, then sleeps, for up to 20 ms. Returns
+	// false if no segment exists, nothing has been published yet or the
+	// writer did not finish in time.
+	bool read(GridSnapshot &snapshot);
+
+  private:
+	bool attach();
+	void detach();
+
+	std::string name;
+	int fd;
+	void *mapping;
+	size_t mapping_size;
+};
+
+}
+
+#endif
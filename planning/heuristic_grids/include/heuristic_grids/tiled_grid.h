@@ -0,0 +1,170 @@
+#ifndef HEURISTIC_GRIDS_TILED_GRID_H
+#define HEURISTIC_GRIDS_TILED_GRID_H
+
+#include <algorithm>
+#include <memory>
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+#include "heuristic_grids/grid2d.h"
+
+// Grid split into tiles of GRID_TILE_ROWS rows (x-major, so a tile is a band
+// along x), each a Grid2D shared between copies of the grid. Copying a
+// TiledGrid copies the tile pointers, a tile is only copied when a copy
+// writes into it. Lets heuristic_grids_server build the next GridSnapshot
+// from the current one in the time of the squares that changed.
+
+namespace heuristic_grids
+{
+
+static const int GRID_TILE_ROWS = 16;
+
+template <typename T>
+class TiledGrid
+{
+  public:
+	TiledGrid()
+		: num_grid_squares_x(0), num_grid_squares_y(0), grid_square_size(1)
+	{
+	}
+
+	// Resizes and sets every cell to value, no tile is shared afterwards
+	void reset(int num_grid_squares_x, int num_grid_squares_y, float grid_square_size, T value = T())
+	{
+		this->num_grid_squares_x = num_grid_squares_x > 0 ? num_grid_squares_x : 0;
+		this->num_grid_squares_y = num_grid_squares_y > 0 ? num_grid_squares_y : 0;
+		this->grid_square_size = grid_square_size;
+
+		int num_tiles = (this->num_grid_squares_x + GRID_TILE_ROWS - 1) / GRID_TILE_ROWS;
+
+		tiles.resize(num_tiles);
+		rows.resize(this->num_grid_squares_x);
+
+		for (int tile = 0; tile < num_tiles; tile++)
+		{
+			int tile_rows = std::min(GRID_TILE_ROWS, this->num_grid_squares_x - tile * GRID_TILE_ROWS);
+			tiles[tile] = std::make_shared<Grid2D<T> >(tile_rows, this->num_grid_squares_y, grid_square_size, value);
+			mapRows(tile);
+		}
+	}
+
+	bool empty() const
+	{
+		return rows.empty() || num_grid_squares_y == 0;
+	}
+
+	size_t size() const
+	{
+		return size_t(num_grid_squares_x) * num_grid_squares_y;
+	}
+
+	int numGridSquaresX() const
+	{
+		return num_grid_squares_x;
+	}
+
+	int numGridSquaresY() const
+	{
+		return num_grid_squares_y;
+	}
+
+	float gridSquareSize() const
+	{
+		return grid_square_size;
+	}
+
+	bool withinGrid(int i, int j) const
+	{
+		return i >= 0 && j >= 0 && i < num_grid_squares_x && j < num_grid_squares_y;
+	}
+
+	// Unchecked. Reading never copies a tile, so there is no writable
+	// counterpart, see writableRow.
+	const T &operator()(int i, int j) const
+	{
+		return rows[i][j];
+	}
+
+	const T *row(int i) const
+	{
+		return rows[i];
+	}
+
+	// Checked, outside is returned for cells outside the grid
+	T at(int i, int j, T outside) const
+	{
+		return withinGrid(i, j) ? rows[i][j] : outside;
+	}
+
+	// The num_grid_squares_y cells with the same i, for writing. Copies the
+	// tile first if another grid shares it.
+	T *writableRow(int i)
+	{
+		int tile = i / GRID_TILE_ROWS;
+
+		if (tiles[tile].use_count() > 1)
+		{
+			tiles[tile] = std::make_shared<Grid2D<T> >(*tiles[tile]);
+			mapRows(tile);
+		}
+
+		return rows[i];
+	}
+
+	// Copies rows i_min to i_max of a grid of the same size
+	void assign(const Grid2D<T> &grid, int i_min, int i_max)
+	{
+		for (int i = std::max(i_min, 0); i <= std::min(i_max, num_grid_squares_x - 1); i++)
+			memcpy(writableRow(i), grid.row(i), num_grid_squares_y * sizeof(T));
+	}
+
+	// Resized to and copied from grid
+	void assign(const Grid2D<T> &grid)
+	{
+		if (grid.numGridSquaresX() != num_grid_squares_x || grid.numGridSquaresY() != num_grid_squares_y)
+			reset(grid.numGridSquaresX(), grid.numGridSquaresY(), grid.gridSquareSize());
+
+		assign(grid, 0, num_grid_squares_x - 1);
+	}
+
+	// Copies every cell into grid, resized to this one
+	void copyTo(Grid2D<T> &grid) const
+	{
+		grid.reset(num_grid_squares_x, num_grid_squares_y, grid_square_size);
+
+		for (int i = 0; i < num_grid_squares_x; i++)
+			memcpy(grid.row(i), rows[i], num_grid_squares_y * sizeof(T));
+	}
+
+	int numTiles() const
+	{
+		return tiles.size();
+	}
+
+	// Whether tile holds the same cells in both grids because neither wrote
+	// into it since one was copied from the other
+	bool sharesTile(const TiledGrid &other, int tile) const
+	{
+		return tile < int(other.tiles.size()) && tiles[tile] == other.tiles[tile];
+	}
+
+  private:
+	void mapRows(int tile)
+	{
+		Grid2D<T> &cells = *tiles[tile];
+
+		for (int i = 0; i < cells.numGridSquaresX(); i++)
+			rows[tile * GRID_TILE_ROWS + i] = cells.empty() ? NULL : cells.row(i);
+	}
+
+	int num_grid_squares_x, num_grid_squares_y;
+	float grid_square_size;
+	std::vector<std::shared_ptr<Grid2D<T> > > tiles;
+
+	// Start of every row, within its tile
+	std::vector<T *> rows;
+};
+
+}
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef HEURISTIC_GRIDS_WALL_INFLATION_H
+#define HEURISTIC_GRIDS_WALL_INFLATION_H
+
+#include <stdint.h>
+#include <vector>
+#include "heuristic_grids/grid2d.h"
+
+namespace heuristic_grids
+{
+
+// Inclusive range of grid squares
+struct GridRegion
+{
+	int i_min, j_min, i_max, j_max;
+
+	GridRegion();
+
+	bool empty() const;
+	void add(int i, int j);
+	void add(const GridRegion &other);
+};
+
+// Walls inflated by a radius: every square within radius_squares (Euclidean,
+// in squares) of a square holding a wall point, the same squares as stamping
+// a disc around every point. Computed from the exact distance transform of
+// the wall point squares, so the work does not grow with the number of points
+// or the disc area. Adding points only redoes the transform around them.
+class WallInflation
+{
+  public:
+	WallInflation();
+
+	// Empty grid of the given size
+	void reset(int num_grid_squares_x, int num_grid_squares_y, float grid_square_size, int radius_squares);
+
+	// Adds wall points, returns the squares whose inflation may have changed.
+	// Empty if every point was already known or too far outside the grid.
+	GridRegion addPoints(const std::vector<float> &X_wall_coordinates, const std::vector<float> &Y_wall_coordinates);
+
+	// Adds points whose inflation is already known, e.g. from a grid cache,
+	// without transforming
+	void restore(const std::vector<float> &X_wall_coordinates, const std::vector<float> &Y_wall_coordinates,
+				 const Grid2D<uint8_t> &inflated_walls);
+
+	bool inflated(int i, int j) const;
+
+	// Inflated walls at 1, the walls of a GridSnapshot
+	const Grid2D<uint8_t> &walls() const;
+
+	int numGridSquaresX() const;
+	int numGridSquaresY() const;
+
+  private:
+	GridRegion markPoints(const std::vector<float> &X_wall_coordinates, const std::vector<float> &Y_wall_coordinates);
+	void transform(const GridRegion &region);
+
+	int num_grid_squares_x, num_grid_squares_y;
+	float grid_square_size;
+	int radius_squares;
+
+	// Squares holding wall points, on the grid padded by the radius, square
+	// (i, j) at (i + radius_squares, j + radius_squares)
+	Grid2D<uint8_t> points;
+	Grid2D<uint8_t> inflated_walls;
+
+	// Scratch space of the transform
+	std::vector<double> column_distances, f, d, z;
+	std::vector<int> v;
+};
+
+}
+
+#endif
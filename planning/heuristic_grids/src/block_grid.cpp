@@ -0,0 +1,136 @@
+#include "heuristic_grids/block_grid.h"
+
+namespace heuristic_grids
+{
+
+BlockGrid::BlockGrid()
+	: block_size(DEFAULT_BLOCK_SIZE), num_blocks_x(0), num_blocks_y(0), grid_square_size(0.02)
+{
+}
+
+void BlockGrid::build(const GridSnapshot &grid, int block_size)
+{
+	this->block_size = std::max(block_size, 1);
+	num_blocks_x = (grid.num_grid_squares_x + this->block_size - 1) / this->block_size;
+	num_blocks_y = (grid.num_grid_squares_y + this->block_size - 1) / this->block_size;
+	grid_square_size = grid.grid_square_size;
+
+	max_occupancy.reset(num_blocks_x, num_blocks_y, this->block_size * grid_square_size, 1);
+
+	for (int block_i = 0; block_i < num_blocks_x; block_i++)
+	{
+		for (int block_j = 0; block_j < num_blocks_y; block_j++)
+			summarize(grid, block_i, block_j);
+	}
+
+	computeFreeRadius();
+}
+
+void BlockGrid::update(const GridSnapshot &grid, int i_min, int j_min, int i_max, int j_max)
+{
+	int block_i_min = std::max(block(i_min), 0);
+	int block_j_min = std::max(block(j_min), 0);
+	int block_i_max = std::min(block(i_max), num_blocks_x - 1);
+	int block_j_max = std::min(block(j_max), num_blocks_y - 1);
+
+	for (int block_i = block_i_min; block_i <= block_i_max; block_i++)
+	{
+		for (int block_j = block_j_min; block_j <= block_j_max; block_j++)
+			summarize(grid, block_i, block_j);
+	}
+
+	// A few hundred blocks, cheaper to redo than to track
+	computeFreeRadius();
+}
+
+bool BlockGrid::regionFree(int i_min, int j_min, int i_max, int j_max) const
+{
+	int block_i_min = block(i_min), block_i_max = block(i_max);
+	int block_j_min = block(j_min), block_j_max = block(j_max);
+
+	// The free blocks around the middle one have to cover all of them
+	int block_i = (block_i_min + block_i_max) / 2;
+	int block_j = (block_j_min + block_j_max) / 2;
+	int radius = std::max(std::max(block_i - block_i_min, block_i_max - block_i), std::max(block_j - block_j_min, block_j_max - block_j));
+
+	if (block_i < 0 || block_j < 0 || block_i >= num_blocks_x || block_j >= num_blocks_y)
+		return false;
+
+	return free_radius(block_i, block_j) > radius;
+}
+
+void BlockGrid::summarize(const GridSnapshot &grid, int block_i, int block_j)
+{
+	float value = 0;
+
+	// Squares past the edge of the grid make the block occupied
+	for (int i = block_i * block_size; i < (block_i + 1) * block_size; i++)
+	{
+		for (int j = block_j * block_size; j < (block_j + 1) * block_size; j++)
+			value = std::max(value, grid.occupancyAtCell(i, j));
+	}
+
+	max_occupancy(block_i, block_j) = value;
+}
+
+// Two pass chamfer with unit steps to all 8 neighbours, exact for the
+// Chebyshev distance
+void BlockGrid::computeFreeRadius()
+{
+	free_radius.reset(num_blocks_x, num_blocks_y, max_occupancy.gridSquareSize(), 0);
+
+	for (int block_i = 0; block_i < num_blocks_x; block_i++)
+	{
+		for (int block_j = 0; block_j < num_blocks_y; block_j++)
+		{
+			size_t k = block_i * num_blocks_y + block_j;
+
+			if (max_occupancy[k] > 0)
+				continue;
+
+			// Outside the grid is not free
+			int radius = std::min(block_i, block_j) + 1;
+
+			if (block_i > 0)
+			{
+				radius = std::min(radius, free_radius[k - num_blocks_y] + 1);
+				if (block_j > 0)
+					radius = std::min(radius, free_radius[k - num_blocks_y - 1] + 1);
+				if (block_j < num_blocks_y - 1)
+					radius = std::min(radius, free_radius[k - num_blocks_y + 1] + 1);
+			}
+			if (block_j > 0)
+				radius = std::min(radius, free_radius[k - 1] + 1);
+
+			free_radius[k] = radius;
+		}
+	}
+
+	for (int block_i = num_blocks_x - 1; block_i >= 0; block_i--)
+	{
+		for (int block_j = num_blocks_y - 1; block_j >= 0; block_j--)
+		{
+			size_t k = block_i * num_blocks_y + block_j;
+
+			if (free_radius[k] == 0)
+				continue;
+
+			int radius = std::min(free_radius[k], std::min(num_blocks_x - block_i, num_blocks_y - block_j));
+
+			if (block_i < num_blocks_x - 1)
+			{
+				radius = std::min(radius, free_radius[k + num_blocks_y] + 1);
+				if (block_j > 0)
+					radius = std::min(radius, free_radius[k + num_blocks_y - 1] + 1);
+				if (block_j < num_blocks_y - 1)
+					radius = std::min(radius, free_radius[k + num_blocks_y + 1] + 1);
+			}
+			if (block_j < num_blocks_y - 1)
+				radius = std::min(radius, free_radius[k + 1] + 1);
+
+			free_radius[k] = radius;
+		}
+	}
+}
+
+}
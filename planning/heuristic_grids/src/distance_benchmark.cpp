@@ -0,0 +1,192 @@
+// Times the recursive setDistance flood fill the servers used against the
+// breadth first wavefront of DistanceField on a maze, at several grid square
+// sizes, and checks that both give the same distances.
+//
+// rosrun heuristic_grids distance_benchmark <maze file> [goals] [grid square sizes...]
+
+#include <chrono>
+#include <iostream>
+#include <pthread.h>
+#include <random>
+#include <stdlib.h>
+#include <vector>
+#include "heuristic_grids/distance_field.h"
+#include "heuristic_grids/grid_builder.h"
+#include "heuristic_grids/maze_map.h"
+
+namespace
+{
+
+// The recursion goes as deep as the longest path it tries, far beyond the
+// default 8 MB stack on fine grids
+const size_t RECURSIVE_STACK_SIZE = size_t(2) << 30;
+
+// What HeuristicGridsServer::setDistance did, on the snapshot layout
+struct RecursiveFill
+{
+	const heuristic_grids::GridSnapshot *grid;
+	std::vector<int> distances;
+	long calls;
+	int depth, max_depth;
+
+	bool setDistance(int x, int y, int dist)
+	{
+		calls++;
+
+		if (!grid->withinGrid(x, y) || grid->isWall(x, y))
+			return false;
+
+		int &distance = distances[grid->index(x, y)];
+
+		if (distance > dist || distance == 0)
+		{
+			distance = dist;
+
+			depth++;
+			max_depth = std::max(max_depth, depth);
+
+			if (x + 1 < grid->num_grid_squares_x)
+				setDistance(x + 1, y, dist + 1);
+			if (x - 1 >= 0)
+				setDistance(x - 1, y, dist + 1);
+			if (y + 1 < grid->num_grid_squares_y)
+				setDistance(x, y + 1, dist + 1);
+			if (y - 1 >= 0)
+				setDistance(x, y - 1, dist + 1);
+
+			depth--;
+		}
+
+		return true;
+	}
+};
+
+struct RecursiveRun
+{
+	RecursiveFill *fill;
+	int goal_i, goal_j;
+};
+
+void *runRecursive(void *argument)
+{
+	RecursiveRun *run = static_cast<RecursiveRun *>(argument);
+	run->fill->setDistance(run->goal_i, run->goal_j, 0);
+	return NULL;
+}
+
+// False if the thread with the large stack could not be started
+bool fillRecursive(RecursiveFill &fill, int goal_i, int goal_j)
+{
+	RecursiveRun run = {&fill, goal_i, goal_j};
+	pthread_attr_t attributes;
+	pthread_t thread;
+
+	pthread_attr_init(&attributes);
+	pthread_attr_setstacksize(&attributes, RECURSIVE_STACK_SIZE);
+	bool started = pthread_create(&thread, &attributes, runRecursive, &run) == 0;
+	pthread_attr_destroy(&attributes);
+
+	if (started)
+		pthread_join(thread, NULL);
+
+	return started;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " <maze file> [goals] [grid square sizes...]" << std::endl;
+		return 1;
+	}
+
+	int goals = argc > 2 ? atoi(argv[2]) : 3;
+
+	std::vector<float> sizes;
+	for (int k = 3; k < argc; k++)
+		sizes.push_back(atof(argv[k]));
+	if (sizes.empty())
+	{
+		sizes.push_back(0.02);
+		sizes.push_back(0.01);
+	}
+
+	std::vector<heuristic_grids::WallSegment> walls;
+	if (!heuristic_grids::loadMazeFile(argv[1], walls) || walls.empty())
+	{
+		std::cerr << "Could not read " << argv[1] << std::endl;
+		return 1;
+	}
+
+	std::vector<float> X_wall_coordinates, Y_wall_coordinates;
+	heuristic_grids::discretizeWalls(walls, 0.05, X_wall_coordinates, Y_wall_coordinates);
+
+	std::cout << "grid_square_size,cells,goals,recursive_ms,recursive_calls,recursive_max_depth,wavefront_ms,mismatches" << std::endl;
+
+	for (size_t s = 0; s < sizes.size(); s++)
+	{
+		heuristic_grids::GridParameters parameters;
+		parameters.grid_square_size = sizes[s];
+
+		heuristic_grids::GridSnapshot grid;
+		heuristic_grids::buildGrids(X_wall_coordinates, Y_wall_coordinates, parameters, grid);
+
+		std::mt19937 generator(7);
+		std::uniform_int_distribution<int> i_distribution(0, grid.num_grid_squares_x - 1);
+		std::uniform_int_distribution<int> j_distribution(0, grid.num_grid_squares_y - 1);
+
+		double recursive_time = 0, wavefront_time = 0;
+		long calls = 0, mismatches = 0;
+		int max_depth = 0;
+
+		for (int goal = 0; goal < goals; goal++)
+		{
+			int goal_i, goal_j;
+			do
+			{
+				goal_i = i_distribution(generator);
+				goal_j = j_distribution(generator);
+			} while (grid.isWall(goal_i, goal_j));
+
+			RecursiveFill fill = {&grid, std::vector<int>(grid.occupancy.size(), 0), 0, 0, 0};
+
+			std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+			if (!fillRecursive(fill, goal_i, goal_j))
+			{
+				std::cerr << "Could not start the recursive fill" << std::endl;
+				return 1;
+			}
+			recursive_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+			heuristic_grids::DistanceField field;
+
+			start_time = std::chrono::steady_clock::now();
+			field.compute(grid, goal_i, goal_j);
+			wavefront_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+			calls += fill.calls;
+			max_depth = std::max(max_depth, fill.max_depth);
+
+			for (int i = 0; i < grid.num_grid_squares_x; i++)
+			{
+				for (int j = 0; j < grid.num_grid_squares_y; j++)
+				{
+					// 0 also meant unset, so the recursion came back to the goal
+					if (i == goal_i && j == goal_j)
+						continue;
+
+					if (field.distance(i, j) != fill.distances[grid.index(i, j)])
+						mismatches++;
+				}
+			}
+		}
+
+		std::cout << sizes[s] << "," << grid.occupancy.size() << "," << goals << ","
+				  << 1000 * recursive_time / goals << "," << calls / goals << "," << max_depth << ","
+				  << 1000 * wavefront_time / goals << "," << mismatches << std::endl;
+	}
+
+	return 0;
+}
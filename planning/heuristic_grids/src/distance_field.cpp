@@ -0,0 +1,230 @@
+#include "heuristic_grids/distance_field.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace heuristic_grids
+{
+
+namespace
+{
+
+const int di[4] = {1, -1, 0, 0};
+const int dj[4] = {0, 0, 1, -1};
+
+}
+
+DistanceField::DistanceField()
+	: goal_i(-1), goal_j(-1), grid_version(0)
+{
+}
+
+bool DistanceField::compute(const GridSnapshot &grid, int goal_i, int goal_j)
+{
+	int num_grid_squares_y = grid.num_grid_squares_y;
+	this->goal_i = goal_i;
+	this->goal_j = goal_j;
+	grid_version = grid.version;
+
+	field.reset(grid.num_grid_squares_x, num_grid_squares_y, grid.grid_square_size, -1);
+
+	if (grid.isWall(goal_i, goal_j))
+		return false;
+
+	std::vector<int32_t> frontier;
+	frontier.reserve(field.size());
+
+	field(goal_i, goal_j) = 0;
+	frontier.push_back(goal_i * num_grid_squares_y + goal_j);
+
+	for (size_t k = 0; k < frontier.size(); k++)
+	{
+		int i = frontier[k] / num_grid_squares_y;
+		int j = frontier[k] % num_grid_squares_y;
+		int dist = field[frontier[k]] + 1;
+
+		for (int n = 0; n < 4; n++)
+		{
+			int i_next = i + di[n];
+			int j_next = j + dj[n];
+
+			if (grid.isWall(i_next, j_next))
+				continue;
+
+			size_t index = grid.index(i_next, j_next);
+			if (field[index] < 0)
+			{
+				field[index] = dist;
+				frontier.push_back(index);
+			}
+		}
+	}
+
+	return true;
+}
+
+// A square keeps its distance if a neighbour is one step closer to the goal
+bool DistanceField::supported(const GridSnapshot &grid, int i, int j) const
+{
+	int32_t dist = field(i, j);
+
+	if (dist == 0)
+		return true;
+
+	for (int n = 0; n < 4; n++)
+	{
+		if (!grid.isWall(i + di[n], j + dj[n]) && field(i + di[n], j + dj[n]) == dist - 1)
+			return true;
+	}
+
+	return false;
+}
+
+bool DistanceField::update(const GridSnapshot &grid, const std::vector<int32_t> &changed_walls)
+{
+	if (grid.num_grid_squares_x != field.numGridSquaresX() || grid.num_grid_squares_y != field.numGridSquaresY() || field.empty() || grid.isWall(goal_i, goal_j))
+		return compute(grid, goal_i, goal_j);
+
+	int num_grid_squares_y = grid.num_grid_squares_y;
+
+	grid_version = grid.version;
+
+	// Raise: squares that lost the neighbour their distance came from, in
+	// order of their old distance
+	std::vector<std::pair<int32_t, int32_t> > raised;
+	std::vector<int32_t> seeds;
+
+	for (size_t k = 0; k < changed_walls.size(); k++)
+	{
+		int32_t index = changed_walls[k];
+		bool wall = grid.isWall(index / num_grid_squares_y, index % num_grid_squares_y);
+
+		if (wall && field[index] >= 0)
+		{
+			raised.push_back(std::make_pair(index, field[index]));
+			field[index] = -1;
+		}
+		else if (!wall)
+			raised.push_back(std::make_pair(index, -1));
+	}
+
+	// Repairing costs a few times more per square than the wavefront, give
+	// up once a large part of the field lost its support
+	size_t max_raised = field.size() / 16;
+
+	for (size_t k = 0; k < raised.size(); k++)
+	{
+		int i = raised[k].first / num_grid_squares_y;
+		int j = raised[k].first % num_grid_squares_y;
+		int32_t old_dist = raised[k].second;
+
+		if (raised.size() > max_raised)
+			return compute(grid, goal_i, goal_j);
+
+		for (int n = 0; n < 4; n++)
+		{
+			int i_next = i + di[n];
+			int j_next = j + dj[n];
+
+			if (grid.isWall(i_next, j_next))
+				continue;
+
+			size_t index = grid.index(i_next, j_next);
+
+			if (old_dist >= 0 && field[index] == old_dist + 1 && !supported(grid, i_next, j_next))
+			{
+				raised.push_back(std::make_pair(int32_t(index), field[index]));
+				field[index] = -1;
+			}
+		}
+	}
+
+	// Lower: grow the field back from the reachable squares around the
+	// raised and freed ones
+	for (size_t k = 0; k < raised.size(); k++)
+	{
+		int i = raised[k].first / num_grid_squares_y;
+		int j = raised[k].first % num_grid_squares_y;
+
+		for (int n = 0; n < 4; n++)
+		{
+			int i_next = i + di[n];
+			int j_next = j + dj[n];
+
+			if (!grid.isWall(i_next, j_next) && field(i_next, j_next) >= 0)
+				seeds.push_back(grid.index(i_next, j_next));
+		}
+	}
+
+	struct CloserToGoal
+	{
+		const Grid2D<int32_t> &distances;
+		bool operator()(int32_t a, int32_t b) const
+		{
+			return distances[a] < distances[b];
+		}
+	} closer = {field};
+
+	std::sort(seeds.begin(), seeds.end(), closer);
+	seeds.erase(std::unique(seeds.begin(), seeds.end()), seeds.end());
+
+	// Merge the sorted seeds with the wavefront so squares are settled in
+	// order of distance, like the breadth first search
+	std::vector<int32_t> frontier;
+	size_t next_seed = 0, next_frontier = 0;
+
+	while (next_seed < seeds.size() || next_frontier < frontier.size())
+	{
+		int32_t current;
+
+		if (next_frontier >= frontier.size() || (next_seed < seeds.size() && field[seeds[next_seed]] <= field[frontier[next_frontier]]))
+			current = seeds[next_seed++];
+		else
+			current = frontier[next_frontier++];
+
+		int i = current / num_grid_squares_y;
+		int j = current % num_grid_squares_y;
+		int32_t dist = field[current] + 1;
+
+		for (int n = 0; n < 4; n++)
+		{
+			int i_next = i + di[n];
+			int j_next = j + dj[n];
+
+			if (grid.isWall(i_next, j_next))
+				continue;
+
+			size_t index = grid.index(i_next, j_next);
+			if (field[index] < 0 || field[index] > dist)
+			{
+				field[index] = dist;
+				frontier.push_back(index);
+			}
+		}
+	}
+
+	return true;
+}
+
+int DistanceField::distance(int i, int j) const
+{
+	int32_t dist = field.at(i, j, 0);
+	return dist < 0 ? 0 : dist;
+}
+
+bool DistanceField::matches(const GridSnapshot &grid, int goal_i, int goal_j) const
+{
+	return matches(grid.version, goal_i, goal_j);
+}
+
+bool DistanceField::matches(uint32_t grid_version, int goal_i, int goal_j) const
+{
+	return this->grid_version == grid_version && this->goal_i == goal_i && this->goal_j == goal_j && !field.empty();
+}
+
+size_t DistanceField::memory() const
+{
+	return field.size() * sizeof(int32_t);
+}
+
+}
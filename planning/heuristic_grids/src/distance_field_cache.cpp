@@ -0,0 +1,88 @@
+#include "heuristic_grids/distance_field_cache.h"
+
+#include <algorithm>
+
+namespace heuristic_grids
+{
+
+DistanceFieldCache::DistanceFieldCache(size_t max_fields, size_t memory_budget)
+	: hits(0), misses(0), grid_version(0)
+{
+	configure(max_fields, memory_budget);
+}
+
+void DistanceFieldCache::configure(size_t max_fields, size_t memory_budget)
+{
+	this->max_fields = std::max(max_fields, size_t(1));
+	this->memory_budget = memory_budget;
+
+	evict();
+}
+
+const DistanceField *DistanceFieldCache::get(const GridSnapshot &grid, int goal_i, int goal_j)
+{
+	// Every field was made for older grids
+	if (grid.version != grid_version)
+	{
+		entries.clear();
+		grid_version = grid.version;
+	}
+
+	for (std::list<Entry>::iterator entry = entries.begin(); entry != entries.end(); ++entry)
+	{
+		if (entry->goal_i == goal_i && entry->goal_j == goal_j)
+		{
+			hits++;
+			entries.splice(entries.begin(), entries, entry);
+			return &entries.front().field;
+		}
+	}
+
+	misses++;
+
+	if (grid.isWall(goal_i, goal_j))
+		return NULL;
+
+	// Reuse the memory of the least recently used field if it has to go
+	if (entries.size() >= max_fields)
+		entries.splice(entries.begin(), entries, --entries.end());
+	else
+		entries.push_front(Entry());
+
+	Entry &entry = entries.front();
+	entry.goal_i = goal_i;
+	entry.goal_j = goal_j;
+	entry.field.compute(grid, goal_i, goal_j);
+
+	evict();
+
+	return &entries.front().field;
+}
+
+void DistanceFieldCache::evict()
+{
+	while (entries.size() > max_fields || (memory_budget != 0 && entries.size() > 1 && memory() > memory_budget))
+		entries.pop_back();
+}
+
+void DistanceFieldCache::clear()
+{
+	entries.clear();
+}
+
+size_t DistanceFieldCache::size() const
+{
+	return entries.size();
+}
+
+size_t DistanceFieldCache::memory() const
+{
+	size_t bytes = 0;
+
+	for (std::list<Entry>::const_iterator entry = entries.begin(); entry != entries.end(); ++entry)
+		bytes += entry->field.memory();
+
+	return bytes;
+}
+
+}
@@ -0,0 +1,54 @@
+#include "heuristic_grids/grid_builder.h"
+
+#include <algorithm>
+#include <math.h>
+#include <opencv2/imgproc/imgproc.hpp>
+#include "heuristic_grids/grid2d_mat.h"
+#include "heuristic_grids/wall_inflation.h"
+
+namespace heuristic_grids
+{
+
+bool buildGrids(const std::vector<float> &X_wall_coordinates, const std::vector<float> &Y_wall_coordinates,
+				const GridParameters &parameters, GridSnapshot &grid)
+{
+	if (X_wall_coordinates.empty() || X_wall_coordinates.size() != Y_wall_coordinates.size())
+		return false;
+
+	float x_max = *std::max_element(X_wall_coordinates.begin(), X_wall_coordinates.end());
+	float y_max = *std::max_element(Y_wall_coordinates.begin(), Y_wall_coordinates.end());
+
+	int num_grid_squares_x = ceil(x_max / parameters.grid_square_size);
+	int num_grid_squares_y = ceil(y_max / parameters.grid_square_size);
+
+	if (num_grid_squares_x <= 0 || num_grid_squares_y <= 0)
+		return false;
+
+	grid.reset(num_grid_squares_x, num_grid_squares_y, parameters.grid_square_size);
+
+	WallInflation inflation;
+	inflation.reset(grid.num_grid_squares_x, grid.num_grid_squares_y, parameters.grid_square_size,
+					ceil(parameters.min_distance / parameters.grid_square_size));
+	inflation.addPoints(X_wall_coordinates, Y_wall_coordinates);
+
+	int kernel_size = parameters.smoothing_kernel_size;
+	if (kernel_size % 2 == 0)
+		kernel_size += 1;
+
+	// The Gaussian blur of the wall cells
+	Grid2D<float> occupancy_grid(grid.num_grid_squares_x, grid.num_grid_squares_y, parameters.grid_square_size);
+	cv::Mat kernel = cv::getGaussianKernel(kernel_size, parameters.smoothing_kernel_sd);
+	cv::Mat occupancy = matView(occupancy_grid);
+	cv::sepFilter2D(matView(inflation.walls()), occupancy, CV_32F, kernel, kernel);
+	cv::normalize(occupancy, occupancy, 0, 1, cv::NORM_MINMAX);
+	occupancy.setTo(1, matView(inflation.walls()));
+
+	grid.walls.assign(inflation.walls());
+	grid.occupancy.assign(occupancy_grid);
+
+	grid.version++;
+
+	return true;
+}
+
+}
@@ -0,0 +1,237 @@
+#include "heuristic_grids/grid_cache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace heuristic_grids
+{
+
+namespace
+{
+
+const uint32_t GRID_CACHE_MAGIC = 0x52374743; // "R7GC"
+const uint32_t GRID_CACHE_FORMAT = 1;
+
+// Start of the file, the layers follow at HEADER_SIZE
+struct CacheHeader
+{
+	uint32_t magic;
+	uint32_t format;
+	uint64_t key;
+	int32_t num_grid_squares_x;
+	int32_t num_grid_squares_y;
+	float grid_square_size;
+	uint32_t num_layers;
+	uint32_t num_values;
+	uint32_t reserved;
+	double values[GRID_CACHE_MAX_VALUES];
+};
+
+const size_t HEADER_SIZE = (sizeof(CacheHeader) + GRID_ALIGNMENT - 1) / GRID_ALIGNMENT * GRID_ALIGNMENT;
+
+size_t layerSize(int num_grid_squares_x, int num_grid_squares_y)
+{
+	size_t bytes = size_t(num_grid_squares_x) * num_grid_squares_y * sizeof(float);
+	return (bytes + GRID_ALIGNMENT - 1) / GRID_ALIGNMENT * GRID_ALIGNMENT;
+}
+
+uint64_t hashBytes(uint64_t hash, const void *data, size_t size)
+{
+	const unsigned char *bytes = static_cast<const unsigned char *>(data);
+
+	for (size_t k = 0; k < size; k++)
+	{
+		hash ^= bytes[k];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+bool writeAll(int fd, const void *data, size_t size)
+{
+	const char *bytes = static_cast<const char *>(data);
+
+	while (size > 0)
+	{
+		ssize_t written = write(fd, bytes, size);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0)
+			return false;
+
+		bytes += written;
+		size -= written;
+	}
+
+	return true;
+}
+
+// mkdir -p
+void makeDirectories(const std::string &directory)
+{
+	for (size_t slash = directory.find('/', 1); slash != std::string::npos; slash = directory.find('/', slash + 1))
+		mkdir(directory.substr(0, slash).c_str(), 0777);
+
+	mkdir(directory.c_str(), 0777);
+}
+
+}
+
+CachedGrids::CachedGrids()
+	: num_grid_squares_x(0), num_grid_squares_y(0), grid_square_size(0.02)
+{
+}
+
+uint64_t gridCacheKey(const std::vector<float> &X_wall_coordinates, const std::vector<float> &Y_wall_coordinates,
+					  const std::vector<double> &parameters)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	uint64_t sizes[3] = {X_wall_coordinates.size(), Y_wall_coordinates.size(), parameters.size()};
+
+	hash = hashBytes(hash, &GRID_CACHE_FORMAT, sizeof(GRID_CACHE_FORMAT));
+	hash = hashBytes(hash, sizes, sizeof(sizes));
+	if (!X_wall_coordinates.empty())
+		hash = hashBytes(hash, &X_wall_coordinates[0], X_wall_coordinates.size() * sizeof(float));
+	if (!Y_wall_coordinates.empty())
+		hash = hashBytes(hash, &Y_wall_coordinates[0], Y_wall_coordinates.size() * sizeof(float));
+	if (!parameters.empty())
+		hash = hashBytes(hash, &parameters[0], parameters.size() * sizeof(double));
+
+	return hash;
+}
+
+std::string defaultGridCacheDirectory()
+{
+	const char *ros_home = getenv("ROS_HOME");
+	if (ros_home != NULL && ros_home[0] != '\0')
+		return std::string(ros_home) + "/heuristic_grids";
+
+	const char *home = getenv("HOME");
+	return std::string(home != NULL ? home : "/tmp") + "/.ros/heuristic_grids";
+}
+
+std::string gridCachePath(const std::string &directory, const std::string &name, uint64_t key)
+{
+	char hex[17];
+	snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)key);
+
+	return directory + "/" + name + "_" + hex + ".grids";
+}
+
+bool saveGridCache(const std::string &path, uint64_t key, const CachedGrids &grids)
+{
+	size_t cells = size_t(grids.num_grid_squares_x) * grids.num_grid_squares_y;
+
+	if (cells == 0 || grids.values.size() > size_t(GRID_CACHE_MAX_VALUES))
+		return false;
+
+	for (size_t k = 0; k < grids.layers.size(); k++)
+	{
+		if (grids.layers[k].size() != cells)
+			return false;
+	}
+
+	size_t slash = path.rfind('/');
+	if (slash != std::string::npos && slash > 0)
+		makeDirectories(path.substr(0, slash));
+
+	CacheHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = GRID_CACHE_MAGIC;
+	header.format = GRID_CACHE_FORMAT;
+	header.key = key;
+	header.num_grid_squares_x = grids.num_grid_squares_x;
+	header.num_grid_squares_y = grids.num_grid_squares_y;
+	header.grid_square_size = grids.grid_square_size;
+	header.num_layers = grids.layers.size();
+	header.num_values = grids.values.size();
+	for (size_t k = 0; k < grids.values.size(); k++)
+		header.values[k] = grids.values[k];
+
+	// Unique per process, nodes saving the same grids do not interleave
+	char suffix[32];
+	snprintf(suffix, sizeof(suffix), ".%d.tmp", int(getpid()));
+	std::string temporary_path = path + suffix;
+
+	int fd = open(temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0)
+		return false;
+
+	std::vector<char> padding(GRID_ALIGNMENT, 0);
+	size_t layer_bytes = cells * sizeof(float);
+	size_t layer_padding = layerSize(grids.num_grid_squares_x, grids.num_grid_squares_y) - layer_bytes;
+
+	bool written = writeAll(fd, &header, sizeof(header)) && writeAll(fd, &padding[0], HEADER_SIZE - sizeof(header));
+
+	for (size_t k = 0; written && k < grids.layers.size(); k++)
+		written = writeAll(fd, grids.layers[k].data(), layer_bytes) && writeAll(fd, &padding[0], layer_padding);
+
+	written = close(fd) == 0 && written;
+
+	if (!written || rename(temporary_path.c_str(), path.c_str()) != 0)
+	{
+		unlink(temporary_path.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool loadGridCache(const std::string &path, uint64_t key, CachedGrids &grids)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || size_t(info.st_size) < HEADER_SIZE)
+	{
+		close(fd);
+		return false;
+	}
+
+	size_t size = info.st_size;
+	void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (mapping == MAP_FAILED)
+		return false;
+
+	const CacheHeader *header = static_cast<const CacheHeader *>(mapping);
+	size_t layer_size = layerSize(header->num_grid_squares_x, header->num_grid_squares_y);
+
+	bool valid = header->magic == GRID_CACHE_MAGIC && header->format == GRID_CACHE_FORMAT && header->key == key &&
+				 header->num_grid_squares_x > 0 && header->num_grid_squares_y > 0 &&
+				 header->num_values <= uint32_t(GRID_CACHE_MAX_VALUES) &&
+				 size == HEADER_SIZE + header->num_layers * layer_size;
+
+	if (valid)
+	{
+		grids.num_grid_squares_x = header->num_grid_squares_x;
+		grids.num_grid_squares_y = header->num_grid_squares_y;
+		grids.grid_square_size = header->grid_square_size;
+		grids.values.assign(header->values, header->values + header->num_values);
+		grids.layers.resize(header->num_layers);
+
+		const char *layer = static_cast<const char *>(mapping) + HEADER_SIZE;
+
+		for (uint32_t k = 0; k < header->num_layers; k++, layer += layer_size)
+		{
+			grids.layers[k].reset(grids.num_grid_squares_x, grids.num_grid_squares_y, grids.grid_square_size);
+			memcpy(grids.layers[k].data(), layer, grids.layers[k].size() * sizeof(float));
+		}
+	}
+
+	munmap(mapping, size);
+
+	return valid;
+}
+
+}
@@ -0,0 +1,112 @@
+#include "heuristic_grids/grid_encoding.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace heuristic_grids
+{
+
+int bytesPerCell(int encoding)
+{
+	return encoding == GRID_ENCODING_FLOAT16 ? 2 : 1;
+}
+
+void encodeCell(float value, int encoding, float offset, float scale, uint8_t *cell)
+{
+	if (encoding == GRID_ENCODING_FLOAT16)
+	{
+		uint16_t half = floatToHalf(value);
+		cell[0] = half & 0xff;
+		cell[1] = half >> 8;
+		return;
+	}
+
+	float step = scale != 0 ? (value - offset) / scale : 0;
+	if (!(step > 0))
+		cell[0] = 0;
+	else if (step >= 255)
+		cell[0] = 255;
+	else
+		cell[0] = uint8_t(step + 0.5f);
+}
+
+float decodeCell(const uint8_t *cell, int encoding, float offset, float scale)
+{
+	if (encoding == GRID_ENCODING_FLOAT16)
+		return halfToFloat(uint16_t(cell[0] | (cell[1] << 8)));
+
+	return offset + scale * cell[0];
+}
+
+uint16_t floatToHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	uint16_t sign = (bits >> 16) & 0x8000;
+	int exponent = int((bits >> 23) & 0xff) - 127 + 15;
+	uint32_t mantissa = bits & 0x7fffff;
+
+	// Infinity and NaN
+	if (((bits >> 23) & 0xff) == 0xff)
+		return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+
+	if (exponent >= 31)
+		return sign | 0x7c00;
+
+	// Subnormal or zero, the implicit bit joins the mantissa
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+			return sign;
+
+		mantissa |= 0x800000;
+		int shift = 14 - exponent;
+		uint32_t half_mantissa = mantissa >> shift;
+		uint32_t rest = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+
+		if (rest > halfway || (rest == halfway && (half_mantissa & 1)))
+			half_mantissa++;
+
+		return sign | half_mantissa;
+	}
+
+	uint32_t half = (uint32_t(exponent) << 10) | (mantissa >> 13);
+	uint32_t rest = mantissa & 0x1fff;
+
+	// A carry out of the mantissa bumps the exponent, up to infinity
+	if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+		half++;
+
+	return sign | half;
+}
+
+float halfToFloat(uint16_t half)
+{
+	uint32_t sign = uint32_t(half & 0x8000) << 16;
+	int exponent = (half >> 10) & 0x1f;
+	uint32_t mantissa = half & 0x3ff;
+	uint32_t bits;
+
+	if (exponent == 0x1f)
+	{
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	}
+	else if (exponent == 0)
+	{
+		// Zero or subnormal, exact as a float
+		float value = ldexpf(float(mantissa), -24);
+		return sign ? -value : value;
+	}
+	else
+	{
+		bits = sign | (uint32_t(exponent - 15 + 127) << 23) | (mantissa << 13);
+	}
+
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+}
@@ -1,10 +1,16 @@
 #include <algorithm>
 #include <math.h>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 #include "ros/ros.h"
 #include "std_msgs/Bool.h"
 #include "robo7_srvs/IsGridOccupied.h"
+#include "robo7_srvs/IsGridOccupiedBatch.h"
+#include "robo7_srvs/SegmentCost.h"
 #include "robo7_srvs/distanceTo.h"
+#include "robo7_srvs/distanceToMany.h"
 #include "robo7_srvs/UpdateOccupancyGridFiltered.h"
 #include "robo7_msgs/XY_coordinates.h"
 #include <cv_bridge/cv_bridge.h>
@@ -12,28 +18,30 @@
 #include <opencv2/opencv.hpp>
 #include <opencv2/highgui/highgui_c.h>
 #include <image_transport/image_transport.h>
-#include "robo7_msgs/occupancy_matrix.h"
-#include "robo7_msgs/occupancy_row.h"
-#include "robo7_msgs/grid_matrix.h"
-#include "robo7_msgs/grid_row.h"
+#include "robo7_msgs/compact_grid.h"
+#include "robo7_msgs/compact_grid_delta.h"
 #include "robo7_msgs/wallPoint.h"
 #include "robo7_msgs/allObstacles.h"
 #include "robo7_msgs/mapping_grid.h"
-
-typedef std::vector<double> Array;
-typedef std::vector<Array> Matrix;
+#include "heuristic_grids/block_grid.h"
+#include "heuristic_grids/distance_field_cache.h"
+#include "heuristic_grids/grid_cache.h"
+#include "heuristic_grids/grid2d_mat.h"
+#include "heuristic_grids/grid_encoding.h"
+#include "heuristic_grids/segment_cost.h"
+#include "heuristic_grids/shared_grid.h"
+#include "heuristic_grids/wall_inflation.h"
 
 class HeuristicGridsServer
 {
   public:
 	ros::NodeHandle n;
 	ros::Subscriber map_sub, new_point_sub, obstacle_sub, current_occupancy_sub;
-	ros::Publisher occupancy_pub, distance_pub;
-	robo7_msgs::occupancy_matrix occupancy_matrix_msg, distance_matrix_msg;
-	ros::ServiceServer is_occupied_service;
-	ros::ServiceServer distance_to_service;
+	ros::Publisher occupancy_pub, occupancy_delta_pub, distance_pub;
+	robo7_msgs::compact_grid occupancy_grid_msg, distance_grid_msg;
+	ros::ServiceServer is_occupied_service, is_occupied_batch_service, segment_cost_service;
+	ros::ServiceServer distance_to_service, distance_to_many_service;
   ros::ServiceServer update_occupancy_service;
-	Matrix grid;
 
 	HeuristicGridsServer()
 	{
@@ -42,6 +50,18 @@ class HeuristicGridsServer
 		n.param<double>("/heuristic_grids_server/min_distance", min_distance, 0.13);
 		n.param<int>("/heuristic_grids_server/smoothing_kernel_size", smoothing_kernel_size, 15);
 		n.param<int>("/heuristic_grids_server/smoothing_kernel_sd", smoothing_kernel_sd, 3);
+		n.param<bool>("/heuristic_grids_server/publish_shared_grid", publish_shared_grid, true);
+		n.param<std::string>("/heuristic_grids_server/shared_grid_name", shared_grid_name, heuristic_grids::DEFAULT_SHARED_GRID_NAME);
+		n.param<int>("/heuristic_grids_server/distance_cache_size", distance_cache_size, 8);
+		n.param<double>("/heuristic_grids_server/distance_cache_memory_mb", distance_cache_memory_mb, 0);
+		n.param<int>("/heuristic_grids_server/spinner_threads", spinner_threads, 4);
+		n.param<bool>("/heuristic_grids_server/use_grid_cache", use_grid_cache, true);
+		n.param<std::string>("/heuristic_grids_server/grid_cache_directory", grid_cache_directory, heuristic_grids::defaultGridCacheDirectory());
+
+		distance_fields.configure(std::max(distance_cache_size, 1), distance_cache_memory_mb * 1024 * 1024);
+
+		shared_grid_writer = std::make_shared<heuristic_grids::SharedGridWriter>(shared_grid_name);
+		snapshot = std::make_shared<heuristic_grids::GridSnapshot>();
 
     //The different subscribes
 		map_sub = n.subscribe("/own_map/wall_coordinates", 1, &HeuristicGridsServer::mapCallback, this);
@@ -50,12 +70,17 @@ class HeuristicGridsServer
     current_occupancy_sub = n.subscribe("/localization/mapping/the_occupancy_grid", 1, &HeuristicGridsServer::occupancyCallback, this);
 
     is_occupied_service = n.advertiseService("/occupancy_grid/is_occupied", &HeuristicGridsServer::occupancyGridRequest, this);
+		is_occupied_batch_service = n.advertiseService("/occupancy_grid/is_occupied_batch", &HeuristicGridsServer::occupancyBatchRequest, this);
+		segment_cost_service = n.advertiseService("/occupancy_grid/segment_cost", &HeuristicGridsServer::segmentCostRequest, this);
 		distance_to_service = n.advertiseService("/distance_grid/distance", &HeuristicGridsServer::distanceGridRequest, this);
+		distance_to_many_service = n.advertiseService("/distance_grid/distances", &HeuristicGridsServer::distancesRequest, this);
 
     update_occupancy_service = n.advertiseService("/occupancy_grid/update_occupancy_grid", &HeuristicGridsServer::occupancyGridUpdateRequest, this);
 
-		occupancy_pub = n.advertise<robo7_msgs::occupancy_matrix>("/heuristic_grids_server/occupancy_matrix", 1);
-		distance_pub = n.advertise<robo7_msgs::occupancy_matrix>("/heuristic_grids_server/distance_matrix", 1);
+		// Latched, a new subscriber gets the current version right away
+		occupancy_pub = n.advertise<robo7_msgs::compact_grid>("/heuristic_grids_server/occupancy_grid", 1, true);
+		occupancy_delta_pub = n.advertise<robo7_msgs::compact_grid_delta>("/heuristic_grids_server/occupancy_grid_delta", 10);
+		distance_pub = n.advertise<robo7_msgs::compact_grid>("/heuristic_grids_server/distance_grid", 1, true);
 
 		num_min_distance_squares = ceil(min_distance / grid_square_size);
 
@@ -68,28 +93,42 @@ class HeuristicGridsServer
 
   void mapCallback(const robo7_msgs::XY_coordinates::ConstPtr &msg)
 	{
+		std::lock_guard<std::mutex> lock(update_mutex);
 		X_wall_coordinates = msg->X_coordinates;
 		Y_wall_coordinates = msg->Y_coordinates;
 	}
 
   void newpointCallback(const robo7_msgs::wallPoint::ConstPtr &msg)
 	{
+		std::lock_guard<std::mutex> lock(update_mutex);
 		new_point_list_msg = *msg;
 	}
 
   void obstacleCallback(const robo7_msgs::allObstacles::ConstPtr &msg)
 	{
+		std::lock_guard<std::mutex> lock(update_mutex);
 		the_obstacles_msg = *msg;
 	}
 
   void occupancyCallback(const robo7_msgs::mapping_grid::ConstPtr &msg)
   {
+    std::lock_guard<std::mutex> lock(update_mutex);
     the_occupancy_grid_msg = *msg;
   }
 
-	int sq(double coord)
+	// Requests are answered by several threads. Readers answer from the
+	// snapshot they loaded, updates build the next snapshot off to the side
+	// and swap it in, so neither waits for the other.
+	void spin()
+	{
+		ros::AsyncSpinner spinner(std::max(spinner_threads, 1));
+		spinner.start();
+		ros::waitForShutdown();
+	}
+
+	std::shared_ptr<const heuristic_grids::GridSnapshot> currentSnapshot() const
 	{
-		return floor(coord / grid_square_size);
+		return std::atomic_load(&snapshot);
 	}
 
 	bool distanceGridRequest(robo7_srvs::distanceTo::Request &req,
@@ -102,16 +141,38 @@ class HeuristicGridsServer
 		float x_to = req.x_to;
 		float y_to = req.y_to;
 
-		if (x_to != current_x_to || y_to != current_y_to)
+		res.distance = getDistanceFromGrid(x_to, y_to, x_from, y_from);
+
+		return true;
+	}
+
+	// One wavefront from the source answers every target, so ranking many
+	// candidate poses costs a single request
+	bool distancesRequest(robo7_srvs::distanceToMany::Request &req,
+						  robo7_srvs::distanceToMany::Response &res)
+	{
+		ROS_DEBUG("New grid distances request recieved");
+
+		std::shared_ptr<const heuristic_grids::GridSnapshot> grids = currentSnapshot();
+
+		if (grids->empty() || req.x_to.size() != req.y_to.size())
+			return false;
+
+		std::lock_guard<std::mutex> lock(distance_mutex);
+		const heuristic_grids::DistanceField *source_distance = distance_fields.get(*grids, grids->sq(req.x_from), grids->sq(req.y_from));
+
+		if (source_distance == NULL)
+			ROS_WARN("No distance grid was generated for x:%f, y:%f", req.x_from, req.y_from);
+
+		res.distances.resize(req.x_to.size());
+		res.occupancies.resize(req.x_to.size());
+
+		for (size_t k = 0; k < req.x_to.size(); k++)
 		{
-			distance_grid_init = false;
-			current_x_to = x_to;
-			current_y_to = y_to;
-			// ROS_INFO("New target!");
+			res.distances[k] = source_distance == NULL ? 0 : source_distance->distance(grids->sq(req.x_to[k]), grids->sq(req.y_to[k]));
+			res.occupancies[k] = grids->occupancyAt(req.x_to[k], req.y_to[k]);
 		}
 
-		res.distance = getDistanceFromGrid(x_to, y_to, x_from, y_from);
-
 		return true;
 	}
 
@@ -120,33 +181,48 @@ class HeuristicGridsServer
 	{
 		ROS_DEBUG("New grid occupancy request recieved");
 
-		if (sq(req.x) >= num_grid_squares_x || sq(req.y) >= num_grid_squares_y)
-		{
-			res.occupancy = 1.0;
-		}
-		else
-		{
-			float value = occupancy_grid.at<float>(sq(req.x), sq(req.y));
+		// 1.0 outside the grid, 0.0 below 0.0001
+		res.occupancy = currentSnapshot()->occupancyAt(req.x, req.y);
 
-			if (value < 0.0001)
-			{
-				res.occupancy = 0.0;
-			}
-			else
-			{
-				res.occupancy = value;
-			}
-		}
+		return true;
+	}
 
-		if (!occupancy_grid_init)
-		{
-			occupancy_matrix_msg = publishOccupancyGrid();
+	// Same answers as occupancyGridRequest, many points in one round trip
+	bool occupancyBatchRequest(robo7_srvs::IsGridOccupiedBatch::Request &req,
+							   robo7_srvs::IsGridOccupiedBatch::Response &res)
+	{
+		ROS_DEBUG("New grid occupancy batch request recieved");
 
-			for (int i = 0; i < 10; i++)
-				occupancy_pub.publish(occupancy_matrix_msg);
+		std::shared_ptr<const heuristic_grids::GridSnapshot> grids = currentSnapshot();
 
-			occupancy_grid_init = true;
-		}
+		if (grids->empty() || req.x.size() != req.y.size())
+			return false;
+
+		res.occupancies.resize(req.x.size());
+
+		for (size_t k = 0; k < req.x.size(); k++)
+			res.occupancies[k] = grids->occupancyAt(req.x[k], req.y[k]);
+
+		return true;
+	}
+
+	// Occupancy over every square a polyline crosses, e.g. a path to follow
+	bool segmentCostRequest(robo7_srvs::SegmentCost::Request &req,
+							robo7_srvs::SegmentCost::Response &res)
+	{
+		ROS_DEBUG("New segment cost request recieved");
+
+		heuristic_grids::SegmentCost cost;
+		std::shared_ptr<const SnapshotBlocks> blocks = std::atomic_load(&snapshot_blocks);
+
+		// Squares are only walked in the blocks that are not free
+		if (blocks)
+			res.success = heuristic_grids::segmentCost(*blocks->grids, blocks->blocks, req.x, req.y, cost);
+		else
+			res.success = heuristic_grids::segmentCost(*currentSnapshot(), req.x, req.y, cost);
+		res.max_occupancy = cost.max_occupancy;
+		res.integral_occupancy = cost.integral_occupancy;
+		res.length = cost.length;
 
 		return true;
 	}
@@ -156,11 +232,14 @@ class HeuristicGridsServer
 		ROS_DEBUG("Setting heuristic grids size");
 
 		// Wait untill we get our first coordinates
-		while (X_wall_coordinates.size() <= 0)
+		while (X_wall_coordinates.size() <= 0 && ros::ok())
 		{
 			ros::spinOnce();
+			ros::Duration(0.01).sleep();
 		}
 
+		std::lock_guard<std::mutex> lock(update_mutex);
+
 		// Get maximum coordinates in grid
 		float x_max = *max_element(X_wall_coordinates.begin(), X_wall_coordinates.end());
 		float y_max = *max_element(Y_wall_coordinates.begin(), Y_wall_coordinates.end());
@@ -172,242 +251,367 @@ class HeuristicGridsServer
 		ROS_DEBUG("x squares: %d", num_grid_squares_x);
 		ROS_DEBUG("y squares: %d", num_grid_squares_y);
 
-		// Set up sizes
-		grid.resize(num_grid_squares_x);
-		for (int i = 0; i < num_grid_squares_x; ++i)
-			grid[i].resize(num_grid_squares_y);
+		ros::WallTime start_time = ros::WallTime::now();
+		uint64_t cache_key = gridCacheKey();
+
+		if (loadCachedGrids(cache_key))
+		{
+			ROS_INFO("Grids loaded from %s in %.1f ms", gridCachePath(cache_key).c_str(), 1000 * (ros::WallTime::now() - start_time).toSec());
+			return;
+		}
 
 		updateBasicGrid();
-    updateFilteredGrid( grid );
+    updateFilteredGrid();
+
+		ROS_INFO("Grids built in %.1f ms", 1000 * (ros::WallTime::now() - start_time).toSec());
+
+		saveCachedGrids(cache_key);
+	}
+
+	// The grids only depend on the walls and these parameters
+	uint64_t gridCacheKey()
+	{
+		std::vector<double> parameters = {grid_square_size, min_distance, double(smoothing_kernel_size), double(smoothing_kernel_sd)};
+
+		return heuristic_grids::gridCacheKey(X_wall_coordinates, Y_wall_coordinates, parameters);
+	}
+
+	std::string gridCachePath(uint64_t key)
+	{
+		return heuristic_grids::gridCachePath(grid_cache_directory, "heuristic_grids_server", key);
+	}
+
+	// Inflated walls, blurred grid and blur scale of an earlier start on the
+	// same map
+	bool loadCachedGrids(uint64_t key)
+	{
+		heuristic_grids::CachedGrids cached;
+
+		if (!use_grid_cache || !heuristic_grids::loadGridCache(gridCachePath(key), key, cached))
+			return false;
+
+		if (cached.layers.size() != 2 || cached.values.size() != 2 ||
+			cached.num_grid_squares_x != num_grid_squares_x || cached.num_grid_squares_y != num_grid_squares_y)
+			return false;
+
+		occupancy_offset = cached.values[0];
+		occupancy_scale = cached.values[1];
+
+		// Later points are inflated on top of the cached walls
+		heuristic_grids::Grid2D<uint8_t> inflated_walls(num_grid_squares_x, num_grid_squares_y, grid_square_size);
+		cv::Mat inflated_walls_view = heuristic_grids::matView(inflated_walls);
+		heuristic_grids::matView(cached.layers[0]).convertTo(inflated_walls_view, CV_8U);
+
+		inflation.reset(num_grid_squares_x, num_grid_squares_y, grid_square_size, num_min_distance_squares);
+		inflation.restore(X_wall_coordinates, Y_wall_coordinates, inflated_walls);
+
+		cv::Rect all(0, 0, num_grid_squares_y, num_grid_squares_x);
+		std::shared_ptr<heuristic_grids::GridSnapshot> next = nextSnapshot(all);
+		next->occupancy.assign(cached.layers[1]);
+
+		commitSnapshot(next, all);
+
+		return true;
 	}
 
-	double distance_points(int x, int y, int a, int b)
+	void saveCachedGrids(uint64_t key)
 	{
-		double x_diff = x - a;
-		double y_diff = y - b;
-		//ROS_INFO("x: %d, y: %d, a: %d, b: %d", x, y, a, b);
-		return std::sqrt(x_diff * x_diff + y_diff * y_diff);
+		if (!use_grid_cache)
+			return;
+
+		heuristic_grids::CachedGrids cached;
+		cached.num_grid_squares_x = num_grid_squares_x;
+		cached.num_grid_squares_y = num_grid_squares_y;
+		cached.grid_square_size = grid_square_size;
+		cached.values.push_back(occupancy_offset);
+		cached.values.push_back(occupancy_scale);
+		cached.layers.resize(2);
+		currentSnapshot()->occupancy.copyTo(cached.layers[1]);
+
+		cached.layers[0].reset(num_grid_squares_x, num_grid_squares_y, grid_square_size);
+		cv::Mat walls_layer = heuristic_grids::matView(cached.layers[0]);
+		heuristic_grids::matView(inflation.walls()).convertTo(walls_layer, CV_32F);
+
+		if (!heuristic_grids::saveGridCache(gridCachePath(key), key, cached))
+			ROS_WARN("Could not save the grids to %s", gridCachePath(key).c_str());
 	}
 
 	void updateBasicGrid()
 	{
 		ROS_DEBUG("Updating occupancy grid");
 
-		// Put every point in the grid
-		for (int i = 0; i < X_wall_coordinates.size(); ++i)
-		{
-			// Get the square that the point is located in
-			int square_x = sq(X_wall_coordinates[i]);
-			int square_y = sq(Y_wall_coordinates[i]);
+		// The walls enlarged by the min distance
+		inflation.reset(num_grid_squares_x, num_grid_squares_y, grid_square_size, num_min_distance_squares);
+		inflation.addPoints(X_wall_coordinates, Y_wall_coordinates);
+	}
 
-			int x_low = square_x - num_min_distance_squares;
-			int y_low = square_y - num_min_distance_squares;
+	// Gaussian blur of the inflated walls in source, as floats
+	cv::Mat blurWalls(const cv::Rect &source)
+	{
+		cv::Mat kernel = cv::getGaussianKernel(smoothing_kernel_size, smoothing_kernel_sd);
+		cv::Mat grid_filtered;
 
-			int x_high = square_x + num_min_distance_squares;
-			int y_high = square_y + num_min_distance_squares;
+		cv::sepFilter2D(heuristic_grids::matView(inflation.walls())(source), grid_filtered, CV_32F, kernel, kernel);
 
-			// Setting 1.0 for all the walls (enlarged by the min distance)
-			for (int i = x_low; i <= x_high; ++i)
-			{
-				for (int j = y_low; j <= y_high; ++j)
-				{
-					if (!(i < 0) && !(i >= num_grid_squares_x) && !(j < 0) && !(j >= num_grid_squares_y))
-					{
-						// This keeps the wall expansion radial
-						if (distance_points(square_x, square_y, i, j) <= (num_min_distance_squares))
-						{
-							grid[i][j] = 1.0;
-						}
-					}
-				}
-			}
-		}
-  }
+		return grid_filtered;
+	}
 
-  void updateFilteredGrid(Matrix grid_instant)
+  void updateFilteredGrid()
   {
-		// Setting the filtered grid
+		// Setting the filtered grid, blurred straight from the wall cells
+		cv::Rect all(0, 0, num_grid_squares_y, num_grid_squares_x);
+		cv::Mat grid_filtered = blurWalls(all);
 
-		cv::Mat basic_grid(grid_instant.size(), grid_instant.at(0).size(), CV_64FC1);
+		// The scale of the full map is kept for the updates, so that they
+		// stay local and the rest of the map keeps its values
+		double min_filtered, max_filtered;
+		cv::minMaxLoc(grid_filtered, &min_filtered, &max_filtered);
+		occupancy_offset = min_filtered;
+		occupancy_scale = max_filtered > min_filtered ? 1.0 / (max_filtered - min_filtered) : 1.0;
 
-		for (int i = 0; i < basic_grid.rows; ++i)
-		{
-			for (int j = 0; j < basic_grid.cols; ++j)
-			{
-				basic_grid.at<double>(i, j) = grid_instant[i][j];
-			}
-		}
+		std::shared_ptr<heuristic_grids::GridSnapshot> next = nextSnapshot(all);
+		setOccupancy(*next, grid_filtered, all, all);
 
-		occupancy_grid = gaussFilter(basic_grid, smoothing_kernel_size, smoothing_kernel_sd, grid_instant);
+		ROS_INFO("Gaussed grid ready");
+
+		commitSnapshot(next, all);
 	}
 
-	cv::Mat gaussFilter(cv::Mat grid_in, int kernel_size, int sigma, Matrix grid_instant)
+	// Blurs again only around the squares that changed, with the kernel
+	// reaching kernel_size / 2 squares
+	void updateFilteredRegion(const heuristic_grids::GridRegion &region)
 	{
-		cv::Mat grid_filtered;
+		if (region.empty())
+			return;
 
-		GaussianBlur(grid_in, grid_filtered, cv::Size(kernel_size, kernel_size), sigma, 0);
+		int radius = smoothing_kernel_size / 2;
+		cv::Rect all(0, 0, num_grid_squares_y, num_grid_squares_x);
+		cv::Rect changed(region.j_min, region.i_min, region.j_max - region.j_min + 1, region.i_max - region.i_min + 1);
 
-		cv::Mat normalized_grid;
-		cv::normalize(grid_filtered, normalized_grid, 0, 1, cv::NORM_MINMAX, CV_32F);
+		// Squares whose blur changed, and the squares they are blurred from
+		cv::Rect blurred = grow(changed, radius) & all;
+		cv::Rect source = grow(blurred, radius) & all;
 
-		cv::Mat normalized_grid_ones = normalized_grid.clone();
+		std::shared_ptr<heuristic_grids::GridSnapshot> next = nextSnapshot(blurred);
+		setOccupancy(*next, blurWalls(source), source, blurred);
 
-		for (int i = 0; i < normalized_grid.rows; ++i)
-		{
-			for (int j = 0; j < normalized_grid.cols; ++j)
-			{
-				// if(unfiltered_grid[i][j] >= 1){
-				if (grid_instant[i][j] >= 1)
-				{
-					normalized_grid_ones.at<float>(i, j) = 1;
-				}
-			}
-		}
+		ROS_DEBUG("Gaussed grid updated in %d x %d squares", blurred.height, blurred.width);
 
-		//DISPLAY: Uncomment here and
-		// namedWindow("Display window", cv::WINDOW_NORMAL );
-		// cv::resizeWindow("Display window", 600,600);
-		// imshow( "Display window", grid_in );
-		// cv::waitKey(0);
-		// imshow( "Display window", grid_filtered );
-		// cv::waitKey(0);
-		// imshow( "Display window", normalized_grid );
-		// cv::waitKey(0);
-		// imshow( "Display window", normalized_grid_ones );
-		// cv::waitKey(0);
-		// cvDestroyWindow("Display window");
+		commitSnapshot(next, blurred);
+	}
 
-		ROS_INFO("Gaussed grid ready");
-		return normalized_grid_ones;
+	static cv::Rect grow(const cv::Rect &rect, int squares)
+	{
+		return cv::Rect(rect.x - squares, rect.y - squares, rect.width + 2 * squares, rect.height + 2 * squares);
 	}
 
-	bool setDistance(int x, int y, int dist)
+	// Scales the blurred squares of region into the occupancy of grids,
+	// walls stay 1
+	void setOccupancy(heuristic_grids::GridSnapshot &grids, const cv::Mat &grid_filtered, const cv::Rect &filtered_region, const cv::Rect &region)
 	{
-		if (x >= 0 && y >= 0 && x < num_grid_squares_x && y < num_grid_squares_y)
+		for (int i = region.y; i < region.y + region.height; ++i)
 		{
+			float *occupancy = grids.occupancy.writableRow(i);
 
-			if (grid[x][y] >= 1)
+			for (int j = region.x; j < region.x + region.width; ++j)
 			{
-				return false;
-			}
-			else
-			{
-				if (distance_grid.at<int>(x, y) > dist || distance_grid.at<int>(x, y) == 0)
-				{
-
-					distance_grid.at<int>(x, y) = dist;
-
-					int x_pos = x + 1;
-					int y_pos = y + 1;
-					int x_neg = x - 1;
-					int y_neg = y - 1;
-
-					if (x_pos < num_grid_squares_x)
-					{
-						setDistance(x_pos, y, dist + 1);
-					}
-					if (x_neg >= 0)
-					{
-						setDistance(x_neg, y, dist + 1);
-					}
-					if (y_pos < num_grid_squares_y)
-					{
-						setDistance(x, y_pos, dist + 1);
-					}
-					if (y_neg >= 0)
-					{
-						setDistance(x, y_neg, dist + 1);
-					}
-				}
-				return true;
+				double value = (grid_filtered.at<float>(i - filtered_region.y, j - filtered_region.x) - occupancy_offset) * occupancy_scale;
+
+				if (grids.walls(i, j))
+					value = 1;
+
+				occupancy[j] = std::min(std::max(value, 0.0), 1.0);
 			}
 		}
-		else
+	}
+
+	// The grids the requests read are built in a copy of the current
+	// snapshot, with the inflated walls of region, and replace it once
+	// blurred. The copy shares the tiles outside region with the current one.
+	std::shared_ptr<heuristic_grids::GridSnapshot> nextSnapshot(const cv::Rect &region)
+	{
+		std::shared_ptr<heuristic_grids::GridSnapshot> next = std::make_shared<heuristic_grids::GridSnapshot>(*currentSnapshot());
+
+		if (next->num_grid_squares_x != num_grid_squares_x || next->num_grid_squares_y != num_grid_squares_y)
 		{
-			ROS_WARN("Outside of bounds, x:%d, y:%d, numsqx:%d, numsqy:%d", x, y, num_grid_squares_x, num_grid_squares_y);
-			return false;
+			next->reset(num_grid_squares_x, num_grid_squares_y, grid_square_size);
+			next->walls.assign(inflation.walls());
 		}
+		else
+			next->walls.assign(inflation.walls(), region.y, region.y + region.height - 1);
+
+		return next;
 	}
 
-	int getDistanceFromGrid(double x_to, double y_to, double x_from, double y_from)
+	// Swaps the next snapshot in for new requests and publishes the squares
+	// of region
+	void commitSnapshot(const std::shared_ptr<heuristic_grids::GridSnapshot> &next, const cv::Rect &region)
 	{
+		// Also retires the cached distance fields of the old walls
+		next->version = currentSnapshot()->version + 1;
+
+		std::shared_ptr<const heuristic_grids::GridSnapshot> grids = next;
+		std::atomic_store(&snapshot, grids);
+
+		updateBlocks(grids, region);
+		publishSharedGrid(*grids, region);
+		publishOccupancyGrid(*grids, region);
+	}
+
+	// Summarizes the blocks of region again, in a copy of the current blocks
+	// that is swapped in with the snapshot it summarizes
+	void updateBlocks(const std::shared_ptr<const heuristic_grids::GridSnapshot> &grids, const cv::Rect &region)
+	{
+		std::shared_ptr<const SnapshotBlocks> current = std::atomic_load(&snapshot_blocks);
+		std::shared_ptr<SnapshotBlocks> next = std::make_shared<SnapshotBlocks>();
+
+		next->grids = grids;
 
-		if (distance_grid_init)
+		if (current && current->grids->num_grid_squares_x == grids->num_grid_squares_x && current->grids->num_grid_squares_y == grids->num_grid_squares_y)
 		{
-			return distance_grid.at<int>(sq(x_from), sq(y_from));
+			next->blocks = current->blocks;
+			next->blocks.update(*grids, region.y, region.x, region.y + region.height - 1, region.x + region.width - 1);
 		}
 		else
-		{
-			distance_grid = cv::Mat::zeros(num_grid_squares_x, num_grid_squares_y, CV_32SC1);
+			next->blocks.build(*grids);
 
-			if (!setDistance(sq(x_to), sq(y_to), 0))
-			{
-				ROS_WARN("No distance grid was generated for x:%f, y:%f", x_to, y_to);
-				return 0;
-			}
-			else
-			{
-				// To display, uncomment bellow
-				// cv::Mat normalized_dist_grid;
-				// cv::normalize(distance_grid, normalized_dist_grid, 0, 255, cv::NORM_MINMAX, CV_8UC3);
-				// namedWindow("Display window", cv::WINDOW_NORMAL );
-				// cv::resizeWindow("Display window", 600,600);
-				// imshow( "Display window", normalized_dist_grid );
-				// cv::waitKey(0);
-				// cvDestroyWindow("Display window");
+		std::shared_ptr<const SnapshotBlocks> swapped = next;
+		std::atomic_store(&snapshot_blocks, swapped);
+	}
+
+	// Lets planners on this machine read the grids without service calls.
+	// Only the rows of region are written if the segment holds the last
+	// snapshot.
+	void publishSharedGrid(const heuristic_grids::GridSnapshot &grids, const cv::Rect &region)
+	{
+		if (!publish_shared_grid)
+			return;
+
+		if (shared_grid_writer->publish(grids, region.y, region.y + region.height - 1))
+			ROS_DEBUG("Shared grids version %u published", shared_grid_writer->version());
+		else
+			ROS_WARN("Could not publish grids to shared memory %s", shared_grid_name.c_str());
+	}
 
-				distance_grid_init = true;
+	int getDistanceFromGrid(double x_to, double y_to, double x_from, double y_from)
+	{
+		std::shared_ptr<const heuristic_grids::GridSnapshot> grids = currentSnapshot();
 
-				distance_matrix_msg = publishDistanceGrid();
+		// Only distance requests wait for each other, the fields are cached
+		std::lock_guard<std::mutex> lock(distance_mutex);
+		unsigned long misses = distance_fields.misses;
 
-				for (int i = 0; i < 10; i++)
-					distance_pub.publish(distance_matrix_msg);
+		// Breadth first wavefront from the goal square, unless a recent
+		// request had the same goal on the same grids
+		const heuristic_grids::DistanceField *distance_field = distance_fields.get(*grids, grids->sq(x_to), grids->sq(y_to));
 
-				return distance_grid.at<int>(sq(x_from), sq(y_from));
-			}
+		if (distance_field == NULL)
+		{
+			ROS_WARN("No distance grid was generated for x:%f, y:%f", x_to, y_to);
+			return 0;
 		}
+
+		if (distance_fields.misses != misses)
+		{
+			ROS_DEBUG("Distance fields cached: %zu (%zu bytes), hits: %lu, misses: %lu", distance_fields.size(), distance_fields.memory(), distance_fields.hits, distance_fields.misses);
+
+			// To display, uncomment bellow
+			// cv::Mat normalized_dist_grid;
+			// cv::normalize(distance_grid, normalized_dist_grid, 0, 255, cv::NORM_MINMAX, CV_8UC3);
+			// namedWindow("Display window", cv::WINDOW_NORMAL );
+			// cv::resizeWindow("Display window", 600,600);
+			// imshow( "Display window", normalized_dist_grid );
+			// cv::waitKey(0);
+			// cvDestroyWindow("Display window");
+
+			publishDistanceGrid(*grids, *distance_field);
+		}
+
+		return distance_field->distance(grids->sq(x_from), grids->sq(y_from));
 	}
 
-	robo7_msgs::occupancy_matrix publishOccupancyGrid()
+	// Encodes the squares of region into the latched grid and sends them alone
+	// as a delta to the subscribers already holding the previous version
+	void publishOccupancyGrid(const heuristic_grids::GridSnapshot &grids, const cv::Rect &region)
 	{
-		robo7_msgs::occupancy_row occupancy_row_msg;
-		robo7_msgs::occupancy_matrix occupancy_matrix_msg;
+		bool resized = int(occupancy_grid_msg.num_grid_squares_x) != num_grid_squares_x || int(occupancy_grid_msg.num_grid_squares_y) != num_grid_squares_y;
+
+		if (resized)
+		{
+			occupancy_grid_msg.header.frame_id = "/map";
+			occupancy_grid_msg.num_grid_squares_x = num_grid_squares_x;
+			occupancy_grid_msg.num_grid_squares_y = num_grid_squares_y;
+			occupancy_grid_msg.grid_square_size = grid_square_size;
+			occupancy_grid_msg.encoding = robo7_msgs::compact_grid::ENCODING_UINT8;
+			occupancy_grid_msg.offset = 0;
+			occupancy_grid_msg.scale = 1.0 / 255;
+			occupancy_grid_msg.data.assign(num_grid_squares_x * num_grid_squares_y, 0);
+		}
 
-		std::vector<float> occupancy_row;
+		int bytes = heuristic_grids::bytesPerCell(occupancy_grid_msg.encoding);
 
-		for (int i = 0; i < occupancy_grid.rows; i++)
+		robo7_msgs::compact_grid_region region_msg;
+		region_msg.i_min = region.y;
+		region_msg.j_min = region.x;
+		region_msg.num_grid_squares_x = region.height;
+		region_msg.num_grid_squares_y = region.width;
+		region_msg.data.resize(region.area() * bytes);
+
+		for (int i = region.y; i < region.y + region.height; ++i)
 		{
-			occupancy_row.clear();
-			for (int j = 0; j < occupancy_grid.cols; j++)
+			for (int j = region.x; j < region.x + region.width; ++j)
 			{
-				occupancy_row.push_back(occupancy_grid.at<float>(i, j));
+				uint8_t *cell = &occupancy_grid_msg.data[(i * num_grid_squares_y + j) * bytes];
+				heuristic_grids::encodeCell(grids.occupancy(i, j), occupancy_grid_msg.encoding, occupancy_grid_msg.offset, occupancy_grid_msg.scale, cell);
+				std::copy(cell, cell + bytes, &region_msg.data[((i - region.y) * region.width + j - region.x) * bytes]);
 			}
-			occupancy_row_msg.occupancy_row = occupancy_row;
-			occupancy_matrix_msg.occupancy_rows.push_back(occupancy_row_msg);
 		}
 
-		return occupancy_matrix_msg;
+		robo7_msgs::compact_grid_delta delta_msg;
+		delta_msg.base_version = occupancy_grid_msg.version;
+
+		occupancy_grid_msg.version++;
+		occupancy_grid_msg.header.stamp = ros::Time::now();
+		occupancy_pub.publish(occupancy_grid_msg);
+
+		// A delta of the whole grid would only repeat it
+		if (!resized && region.area() < num_grid_squares_x * num_grid_squares_y)
+		{
+			delta_msg.header = occupancy_grid_msg.header;
+			delta_msg.version = occupancy_grid_msg.version;
+			delta_msg.regions.push_back(region_msg);
+			occupancy_delta_pub.publish(delta_msg);
+		}
+
+		ROS_DEBUG("Occupancy grid version %u published", occupancy_grid_msg.version);
 	}
 
-	robo7_msgs::occupancy_matrix publishDistanceGrid()
+	// Distances in squares as half floats, exact up to 2048 squares
+	void publishDistanceGrid(const heuristic_grids::GridSnapshot &grids, const heuristic_grids::DistanceField &distance_field)
 	{
-		robo7_msgs::occupancy_row distance_row_msg;
-		robo7_msgs::occupancy_matrix distance_matrix_msg;
-
-		std::vector<float> distance_row;
+		int num_grid_squares_x = grids.num_grid_squares_x;
+		int num_grid_squares_y = grids.num_grid_squares_y;
+
+		distance_grid_msg.header.frame_id = "/map";
+		distance_grid_msg.header.stamp = ros::Time::now();
+		distance_grid_msg.version++;
+		distance_grid_msg.num_grid_squares_x = num_grid_squares_x;
+		distance_grid_msg.num_grid_squares_y = num_grid_squares_y;
+		distance_grid_msg.grid_square_size = grids.grid_square_size;
+		distance_grid_msg.encoding = robo7_msgs::compact_grid::ENCODING_FLOAT16;
+		distance_grid_msg.offset = 0;
+		distance_grid_msg.scale = 1;
+		distance_grid_msg.data.resize(num_grid_squares_x * num_grid_squares_y * 2);
 
-		for (int i = 0; i < distance_grid.rows; i++)
+		for (int i = 0; i < num_grid_squares_x; ++i)
 		{
-			distance_row.clear();
-			for (int j = 0; j < distance_grid.cols; j++)
+			for (int j = 0; j < num_grid_squares_y; ++j)
 			{
-				distance_row.push_back(distance_grid.at<float>(i, j));
+				heuristic_grids::encodeCell(distance_field.distance(i, j), distance_grid_msg.encoding, 0, 1, &distance_grid_msg.data[(i * num_grid_squares_y + j) * 2]);
 			}
-			distance_row_msg.occupancy_row = distance_row;
-			distance_matrix_msg.occupancy_rows.push_back(distance_row_msg);
 		}
 
-		return distance_matrix_msg;
+		distance_pub.publish(distance_grid_msg);
 	}
 
   //Here stands an updated version of the occupancy grid that is recomputed
@@ -415,6 +619,9 @@ class HeuristicGridsServer
   bool occupancyGridUpdateRequest(robo7_srvs::UpdateOccupancyGridFiltered::Request &req,
 							  robo7_srvs::UpdateOccupancyGridFiltered::Response &res)
 	{
+    //One update at a time, requests keep reading the current snapshot
+    std::lock_guard<std::mutex> lock(update_mutex);
+
     //Call back the variable
     // the_occupancy_grid_msg = req.current_occupancy_grid;
     new_point_list_msg = req.new_points;
@@ -423,33 +630,29 @@ class HeuristicGridsServer
     // Set up sizes
     if(false)
     {
-  		grid_mapping.resize(the_occupancy_grid_msg.occupancy_grid.nb_rows);
-  		for (int i = 0; i < the_occupancy_grid_msg.occupancy_grid.nb_rows; ++i)
-  			grid_mapping[i].resize(the_occupancy_grid_msg.occupancy_grid.nb_cols);
+      heuristic_grids::Grid2D<uint8_t> walls(the_occupancy_grid_msg.occupancy_grid.nb_rows, the_occupancy_grid_msg.occupancy_grid.nb_cols, grid_square_size);
 
       for(int i=0; i<the_occupancy_grid_msg.occupancy_grid.nb_rows; i++)
       {
         for(int j=0; j<the_occupancy_grid_msg.occupancy_grid.nb_rows; j++)
         {
-          grid_mapping[i][j] = the_occupancy_grid_msg.occupancy_grid.rows[i].cols[j];
+          walls(i, j) = the_occupancy_grid_msg.occupancy_grid.rows[i].cols[j] >= 1;
         }
       }
+      inflation.restore(X_wall_coordinates, Y_wall_coordinates, walls);
+      updateFilteredGrid();
     }
     else
     {
-      grid_mapping = grid;
-      int cell_around = (int)(min_distance/grid_square_size)+2;
-      float dist = min_distance;
-      //Add the new points
+      //Only the walls around the new points and obstacles are redone
+      std::vector<float> x_new, y_new;
       for(int k=0; k < new_point_list_msg.number; k++)
       {
-        float x_loc = new_point_list_msg.the_points[k].x;
-        float y_loc = new_point_list_msg.the_points[k].y;
-        fill_local_cells(x_loc, y_loc, dist, cell_around);
+        x_new.push_back(new_point_list_msg.the_points[k].x);
+        y_new.push_back(new_point_list_msg.the_points[k].y);
       }
 
-      //Add the obstacles
-      cell_around = (int)(min_distance/grid_square_size)+2;
+      //The borders of the obstacles
       for(int k=0; k < the_obstacles_msg.number; k++)
       {
         float x_loc = the_obstacles_msg.the_obstacles[k].x;
@@ -457,74 +660,29 @@ class HeuristicGridsServer
         float o_size = the_obstacles_msg.obstacle_size/2;
         for(float y_spec = y_loc - o_size; y_spec < y_loc + o_size; y_spec += grid_square_size)
         {
-          float x_spec = x_loc - o_size;
-          fill_local_cells(x_spec, y_spec, dist, cell_around);
-          x_spec = x_loc + o_size;
-          fill_local_cells(x_spec, y_spec, dist, cell_around);
+          x_new.push_back(x_loc - o_size);
+          y_new.push_back(y_spec);
+          x_new.push_back(x_loc + o_size);
+          y_new.push_back(y_spec);
         }
         for(float x_spec = x_loc - o_size; x_spec < x_loc + o_size; x_spec += grid_square_size)
         {
-          float y_spec = y_loc - o_size;
-          fill_local_cells(x_spec, y_spec, dist, cell_around);
-          y_spec = y_loc + o_size;
-          fill_local_cells(x_spec, y_spec, dist, cell_around);
+          x_new.push_back(x_spec);
+          y_new.push_back(y_loc - o_size);
+          x_new.push_back(x_spec);
+          y_new.push_back(y_loc + o_size);
         }
       }
 
-      grid = grid_mapping;
+      heuristic_grids::GridRegion changed = inflation.addPoints(x_new, y_new);
+      //Also publishes the new blured squares
+      updateFilteredRegion(changed);
     }
 
-    updateFilteredGrid( grid_mapping );
-
-    //then publish this new blured grid
-    robo7_msgs::occupancy_matrix occupancy_matrix_msg;
-    occupancy_matrix_msg = publishOccupancyGrid();
-
-    occupancy_pub.publish( occupancy_matrix_msg );
-
     res.success = true;
 		return true;
 	}
 
-  std::vector<int> find_index(float x, float y)
-  {
-    std::vector<int> the_local_cell(2,0);
-
-    the_local_cell[0] = (int)(x/grid_square_size + 1/2);
-    the_local_cell[1] = (int)(y/grid_square_size + 1/2);
-
-    return the_local_cell;
-  }
-
-  void fill_local_cells(float x_pos, float y_pos, float dist, int cell_around)
-  {
-    std::vector<int> the_cell_index = find_index(x_pos, y_pos);
-    for(int i=-cell_around+1; i<cell_around; i++)
-    {
-      for(int j=-cell_around+1; j<cell_around; j++)
-      {
-        int local_i = the_cell_index[0] + i;
-        int local_j = the_cell_index[1] + j;
-        if(distance_lower(x_pos, y_pos, local_i, local_j, dist))
-        {
-          if((local_i>0)&&(local_i < static_cast<int>(grid_mapping.size()))
-              &&(local_j>0)&&(local_j < static_cast<int>(grid_mapping[0].size())))
-              {
-                grid_mapping[local_i][local_j] = 1.0;
-              }
-        }
-      }
-    }
-  }
-
-  bool distance_lower(float x1, float y1, int ind_i, int ind_j, float dist)
-  {
-    float x = (ind_i + 1/2) * grid_square_size;
-    float y = (ind_j + 1/2) * grid_square_size;
-
-    return (sqrt(pow(x-x1,2)+pow(y-y1,2)) < dist);
-  }
-
   private:
 	double min_distance;
 	int num_min_distance_squares;
@@ -535,15 +693,32 @@ class HeuristicGridsServer
 	int num_grid_squares_y;
 	std::vector<float> X_wall_coordinates;
 	std::vector<float> Y_wall_coordinates;
-	cv::Mat basic_grid;
-	cv::Mat occupancy_grid;
-	cv::Mat distance_grid;
-	float current_x_to, current_y_to;
-	bool occupancy_grid_init, distance_grid_init;
-  Matrix grid_mapping;
+	double occupancy_offset, occupancy_scale;
   robo7_msgs::wallPoint new_point_list_msg;
   robo7_msgs::allObstacles the_obstacles_msg;
   robo7_msgs::mapping_grid the_occupancy_grid_msg;
+	bool publish_shared_grid;
+	std::string shared_grid_name;
+	int distance_cache_size;
+	double distance_cache_memory_mb;
+	int spinner_threads;
+	bool use_grid_cache;
+	std::string grid_cache_directory;
+	std::shared_ptr<heuristic_grids::SharedGridWriter> shared_grid_writer;
+	std::shared_ptr<const heuristic_grids::GridSnapshot> snapshot;
+
+	// Blocks over a snapshot, for the segment costs
+	struct SnapshotBlocks
+	{
+		std::shared_ptr<const heuristic_grids::GridSnapshot> grids;
+		heuristic_grids::BlockGrid blocks;
+	};
+	std::shared_ptr<const SnapshotBlocks> snapshot_blocks;
+
+	heuristic_grids::DistanceFieldCache distance_fields;
+	// update_mutex guards the grids being built, distance_mutex the cache
+	std::mutex update_mutex, distance_mutex;
+	heuristic_grids::WallInflation inflation;
 };
 
 int main(int argc, char **argv)
@@ -558,21 +733,7 @@ int main(int argc, char **argv)
 
 	heuristic_grids_server.updateBasicGridSize();
 
-  // robo7_msgs::occupancy_matrix occupancy_matrix_msg;
-  // robo7_msgs::occupancy_matrix distance_matrix_msg;
-	// while (ros::ok())
-	// {
-	// 	occupancy_matrix_msg = heuristic_grids_server.publishOccupancyGrid();
-	// 	distance_matrix_msg = heuristic_grids_server.publishDistanceGrid();
-  //
-	// 	heuristic_grids_server.occupancy_pub.publish(occupancy_matrix_msg);
-	// 	heuristic_grids_server.distance_pub.publish(distance_matrix_msg);
-  //
-	// 	ros::spinOnce();
-	// 	loop_rate.sleep();
-	// }
-
-  ros::spin();
+  heuristic_grids_server.spin();
 
 	return 0;
 }
@@ -0,0 +1,65 @@
+#include "heuristic_grids/maze_map.h"
+
+#include <fstream>
+#include <limits>
+#include <math.h>
+#include <sstream>
+
+namespace heuristic_grids
+{
+
+bool loadMazeFile(const std::string &map_file, std::vector<WallSegment> &walls)
+{
+	std::ifstream map_fs(map_file.c_str());
+
+	if (!map_fs.is_open())
+		return false;
+
+	std::string line;
+	walls.clear();
+
+	while (getline(map_fs, line))
+	{
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		double max_num = std::numeric_limits<double>::max();
+		double x1 = max_num, y1 = max_num, x2 = max_num, y2 = max_num;
+
+		std::istringstream line_stream(line);
+		line_stream >> x1 >> y1 >> x2 >> y2;
+
+		// Skip segment errors
+		if (x1 == max_num || y1 == max_num || x2 == max_num || y2 == max_num)
+			continue;
+
+		WallSegment wall = {float(x1), float(y1), float(x2), float(y2)};
+		walls.push_back(wall);
+	}
+
+	return true;
+}
+
+void discretizeWalls(const std::vector<WallSegment> &walls, float discretization_step,
+					 std::vector<float> &X_wall_coordinates, std::vector<float> &Y_wall_coordinates)
+{
+	X_wall_coordinates.assign(1, 0);
+	Y_wall_coordinates.assign(1, 0);
+
+	for (size_t k = 0; k < walls.size(); k++)
+	{
+		const WallSegment &wall = walls[k];
+
+		int N_step = floor(sqrt(pow(wall.x1 - wall.x2, 2) + pow(wall.y1 - wall.y2, 2)) / discretization_step) + 1;
+		float x_step = (wall.x2 - wall.x1) / N_step;
+		float y_step = (wall.y2 - wall.y1) / N_step;
+
+		for (int i = 0; i < N_step + 1; i++)
+		{
+			X_wall_coordinates.push_back(wall.x1 + i * x_step);
+			Y_wall_coordinates.push_back(wall.y1 + i * y_step);
+		}
+	}
+}
+
+}
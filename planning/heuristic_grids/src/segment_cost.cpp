@@ -0,0 +1,65 @@
+#include "heuristic_grids/segment_cost.h"
+
+#include <algorithm>
+#include <math.h>
+#include "heuristic_grids/grid_traversal.h"
+
+namespace heuristic_grids
+{
+
+bool segmentCost(const GridSnapshot &grid, const std::vector<float> &x, const std::vector<float> &y, SegmentCost &cost)
+{
+	cost = SegmentCost();
+
+	if (x.size() < 2 || x.size() != y.size() || grid.empty())
+		return false;
+
+	for (size_t k = 1; k < x.size(); k++)
+	{
+		float segment_length = sqrt(pow(x[k] - x[k - 1], 2) + pow(y[k] - y[k - 1], 2));
+		GridTraversal traversal(x[k - 1], y[k - 1], x[k], y[k], grid.grid_square_size);
+		float enter = 0;
+
+		do
+		{
+			float occupancy = grid.occupancyAtCell(traversal.i(), traversal.j());
+			float exit = traversal.exit();
+
+			cost.max_occupancy = std::max(cost.max_occupancy, occupancy);
+			cost.integral_occupancy += occupancy * std::max(exit - enter, 0.0f) * segment_length;
+			enter = std::max(enter, exit);
+		} while (traversal.next());
+
+		cost.length += segment_length;
+	}
+
+	return true;
+}
+
+bool segmentCost(const GridSnapshot &grid, const BlockGrid &blocks, const std::vector<float> &x, const std::vector<float> &y, SegmentCost &cost)
+{
+	cost = SegmentCost();
+
+	if (x.size() < 2 || x.size() != y.size() || grid.empty() || blocks.empty())
+		return false;
+
+	for (size_t k = 1; k < x.size(); k++)
+	{
+		float segment_length = sqrt(pow(x[k] - x[k - 1], 2) + pow(y[k] - y[k - 1], 2));
+
+		// Free blocks add nothing to either cost
+		traverseBlocks(blocks, x[k - 1], y[k - 1], x[k], y[k], 1e-9, [&grid, &cost, segment_length](int i, int j, float enter, float exit) {
+			float occupancy = grid.occupancyAtCell(i, j);
+
+			cost.max_occupancy = std::max(cost.max_occupancy, occupancy);
+			cost.integral_occupancy += occupancy * (exit - enter) * segment_length;
+			return true;
+		});
+
+		cost.length += segment_length;
+	}
+
+	return true;
+}
+
+}
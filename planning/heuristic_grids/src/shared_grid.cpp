@@ -0,0 +1,408 @@
+#include "heuristic_grids/shared_grid.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <math.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace heuristic_grids
+{
+
+namespace
+{
+
+const uint32_t SHARED_GRID_MAGIC = 0x52374847; // "R7HG"
+
+// A reader waits this long for the writer to finish copying rows [us]
+const int MAX_READ_WAIT = 20000;
+// Attempts that only yield before sleeping between attempts
+const int READ_YIELDS = 16;
+const long READ_SLEEP = 50000; // ns
+
+// Gives the writer time to finish before the next read attempt
+void backOff(int attempt)
+{
+	if (attempt <= READ_YIELDS)
+	{
+		sched_yield();
+		return;
+	}
+
+	timespec pause = {0, READ_SLEEP};
+	nanosleep(&pause, NULL);
+}
+
+// Header at the start of the segment, followed by `capacity` floats of
+// occupancy and `capacity` bytes of walls. `sequence` is odd while the writer
+// is copying, readers retry if it changed during their copy (seqlock).
+struct SegmentHeader
+{
+	uint32_t magic;
+	std::atomic<uint32_t> sequence;
+	uint32_t version;
+	int32_t num_grid_squares_x;
+	int32_t num_grid_squares_y;
+	float grid_square_size;
+	uint64_t capacity;
+};
+
+const size_t HEADER_SIZE = 64;
+
+size_t segmentSize(size_t cells)
+{
+	return HEADER_SIZE + cells * (sizeof(float) + sizeof(uint8_t));
+}
+
+SegmentHeader *header(void *mapping)
+{
+	return static_cast<SegmentHeader *>(mapping);
+}
+
+float *occupancyData(void *mapping)
+{
+	return reinterpret_cast<float *>(static_cast<char *>(mapping) + HEADER_SIZE);
+}
+
+uint8_t *wallData(void *mapping, size_t capacity)
+{
+	return reinterpret_cast<uint8_t *>(occupancyData(mapping) + capacity);
+}
+
+}
+
+GridSnapshot::GridSnapshot()
+	: version(0), num_grid_squares_x(0), num_grid_squares_y(0), grid_square_size(0.02)
+{
+}
+
+void GridSnapshot::reset(int num_grid_squares_x, int num_grid_squares_y, float grid_square_size)
+{
+	this->num_grid_squares_x = num_grid_squares_x;
+	this->num_grid_squares_y = num_grid_squares_y;
+	this->grid_square_size = grid_square_size;
+	occupancy.reset(num_grid_squares_x, num_grid_squares_y, grid_square_size);
+	walls.reset(num_grid_squares_x, num_grid_squares_y, grid_square_size);
+}
+
+bool GridSnapshot::empty() const
+{
+	return version == 0 || occupancy.empty();
+}
+
+int GridSnapshot::sq(float coord) const
+{
+	return floor(coord / grid_square_size);
+}
+
+bool GridSnapshot::withinGrid(int i, int j) const
+{
+	return i >= 0 && j >= 0 && i < num_grid_squares_x && j < num_grid_squares_y;
+}
+
+size_t GridSnapshot::index(int i, int j) const
+{
+	return size_t(i) * num_grid_squares_y + j;
+}
+
+float GridSnapshot::occupancyAt(float x, float y) const
+{
+	return occupancyAtCell(sq(x), sq(y));
+}
+
+float GridSnapshot::occupancyAtCell(int i, int j) const
+{
+	if (!withinGrid(i, j))
+		return 1.0;
+
+	float value = occupancy(i, j);
+
+	if (value < 0.0001)
+		return 0.0;
+	else
+		return value;
+}
+
+bool GridSnapshot::isWall(int i, int j) const
+{
+	return !withinGrid(i, j) || walls(i, j) != 0;
+}
+
+SharedGridWriter::SharedGridWriter(const std::string &name)
+	: name(name), fd(-1), mapping(NULL), mapping_size(0), current_version(0), published_version(0)
+{
+}
+
+SharedGridWriter::~SharedGridWriter()
+{
+	// The segment is left in place so that readers keep the last grids if the
+	// server restarts, a new server continues the version count.
+	unmap();
+
+	if (fd >= 0)
+		close(fd);
+}
+
+void SharedGridWriter::unmap()
+{
+	if (mapping != NULL)
+		munmap(mapping, mapping_size);
+
+	mapping = NULL;
+	mapping_size = 0;
+}
+
+size_t SharedGridWriter::capacity() const
+{
+	return mapping == NULL ? 0 : (mapping_size - HEADER_SIZE) / (sizeof(float) + sizeof(uint8_t));
+}
+
+bool SharedGridWriter::reserve(size_t cells)
+{
+	if (capacity() >= cells)
+		return true;
+
+	if (fd < 0)
+	{
+		fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0666);
+		if (fd < 0)
+			return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+		return false;
+
+	size_t size = std::max(size_t(info.st_size), segmentSize(cells));
+
+	if (size_t(info.st_size) < size && ftruncate(fd, size) != 0)
+		return false;
+
+	unmap();
+
+	mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (mapping == MAP_FAILED)
+	{
+		mapping = NULL;
+		return false;
+	}
+	mapping_size = size;
+
+	SegmentHeader *segment = header(mapping);
+
+	if (segment->magic == SHARED_GRID_MAGIC)
+	{
+		// Left behind by a previous server, keep counting from its version
+		current_version = std::max(current_version, segment->version);
+		if (segment->sequence.load() & 1)
+			segment->sequence.fetch_add(1);
+	}
+	else
+	{
+		segment->sequence.store(0);
+		segment->version = 0;
+		segment->capacity = 0;
+		segment->magic = SHARED_GRID_MAGIC;
+	}
+
+	return true;
+}
+
+bool SharedGridWriter::publish(const GridSnapshot &grids)
+{
+	return publish(grids, 0, grids.num_grid_squares_x - 1);
+}
+
+bool SharedGridWriter::publish(const GridSnapshot &grids, int i_min, int i_max)
+{
+	int num_grid_squares_x = grids.num_grid_squares_x;
+	int num_grid_squares_y = grids.num_grid_squares_y;
+	size_t cells = size_t(num_grid_squares_x) * num_grid_squares_y;
+
+	if (cells == 0 || grids.occupancy.size() != cells || grids.walls.size() != cells)
+		return false;
+
+	if (!reserve(cells))
+		return false;
+
+	SegmentHeader *segment = header(mapping);
+
+	// The other rows are only current if the segment holds our last publish
+	// of a grid of the same size
+	if (published_version == 0 || segment->version != published_version || segment->capacity != capacity() || segment->num_grid_squares_x != num_grid_squares_x || segment->num_grid_squares_y != num_grid_squares_y || segment->grid_square_size != grids.grid_square_size)
+	{
+		i_min = 0;
+		i_max = num_grid_squares_x - 1;
+	}
+
+	i_min = std::max(i_min, 0);
+	i_max = std::min(i_max, num_grid_squares_x - 1);
+
+	segment->sequence.fetch_add(1, std::memory_order_acq_rel);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	segment->num_grid_squares_x = num_grid_squares_x;
+	segment->num_grid_squares_y = num_grid_squares_y;
+	segment->grid_square_size = grids.grid_square_size;
+	segment->capacity = capacity();
+
+	float *occupancy = occupancyData(mapping);
+	uint8_t *walls = wallData(mapping, segment->capacity);
+
+	for (int i = i_min; i <= i_max; i++)
+	{
+		memcpy(occupancy + size_t(i) * num_grid_squares_y, grids.occupancy.row(i), num_grid_squares_y * sizeof(float));
+		memcpy(walls + size_t(i) * num_grid_squares_y, grids.walls.row(i), num_grid_squares_y * sizeof(uint8_t));
+	}
+
+	segment->version = ++current_version;
+	published_version = current_version;
+
+	std::atomic_thread_fence(std::memory_order_release);
+	segment->sequence.fetch_add(1, std::memory_order_acq_rel);
+
+	return true;
+}
+
+uint32_t SharedGridWriter::version() const
+{
+	return current_version;
+}
+
+SharedGridReader::SharedGridReader(const std::string &name)
+	: name(name), fd(-1), mapping(NULL), mapping_size(0)
+{
+}
+
+SharedGridReader::~SharedGridReader()
+{
+	detach();
+}
+
+void SharedGridReader::detach()
+{
+	if (mapping != NULL)
+		munmap(mapping, mapping_size);
+	if (fd >= 0)
+		close(fd);
+
+	mapping = NULL;
+	mapping_size = 0;
+	fd = -1;
+}
+
+bool SharedGridReader::attach()
+{
+	struct stat info;
+
+	if (fd < 0)
+	{
+		fd = shm_open(name.c_str(), O_RDONLY, 0);
+		if (fd < 0)
+			return false;
+	}
+
+	if (fstat(fd, &info) != 0 || size_t(info.st_size) < HEADER_SIZE)
+		return false;
+
+	// Writer grew the segment since we mapped it
+	if (mapping != NULL && size_t(info.st_size) != mapping_size)
+	{
+		munmap(mapping, mapping_size);
+		mapping = NULL;
+	}
+
+	if (mapping == NULL)
+	{
+		mapping = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (mapping == MAP_FAILED)
+		{
+			mapping = NULL;
+			return false;
+		}
+		mapping_size = info.st_size;
+	}
+
+	return header(mapping)->magic == SHARED_GRID_MAGIC;
+}
+
+bool SharedGridReader::read(GridSnapshot &snapshot)
+{
+	if (!attach())
+		return false;
+
+	SegmentHeader *segment = header(mapping);
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(MAX_READ_WAIT);
+
+	for (int attempt = 0;; attempt++)
+	{
+		if (attempt > 0)
+		{
+			if (std::chrono::steady_clock::now() > deadline)
+				return false;
+
+			backOff(attempt);
+		}
+
+		uint32_t sequence = segment->sequence.load(std::memory_order_acquire);
+
+		if (sequence & 1)
+			continue;
+
+		uint32_t version = segment->version;
+		int num_grid_squares_x = segment->num_grid_squares_x;
+		int num_grid_squares_y = segment->num_grid_squares_y;
+		float grid_square_size = segment->grid_square_size;
+		size_t capacity = segment->capacity;
+		size_t cells = size_t(num_grid_squares_x) * num_grid_squares_y;
+
+		if (version == 0)
+			return false;
+
+		if (num_grid_squares_x <= 0 || num_grid_squares_y <= 0 || cells > capacity)
+			continue;
+
+		if (segmentSize(capacity) > mapping_size)
+		{
+			if (!attach())
+				return false;
+			segment = header(mapping);
+			continue;
+		}
+
+		if (version == snapshot.version && !snapshot.empty())
+			return true;
+
+		if (snapshot.occupancy.numGridSquaresX() != num_grid_squares_x || snapshot.occupancy.numGridSquaresY() != num_grid_squares_y)
+			snapshot.reset(num_grid_squares_x, num_grid_squares_y, grid_square_size);
+
+		const float *occupancy = occupancyData(mapping);
+		const uint8_t *walls = wallData(mapping, capacity);
+
+		for (int i = 0; i < num_grid_squares_x; i++)
+		{
+			memcpy(snapshot.occupancy.writableRow(i), occupancy + size_t(i) * num_grid_squares_y, num_grid_squares_y * sizeof(float));
+			memcpy(snapshot.walls.writableRow(i), walls + size_t(i) * num_grid_squares_y, num_grid_squares_y * sizeof(uint8_t));
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (segment->sequence.load(std::memory_order_acquire) != sequence)
+			continue;
+
+		snapshot.version = version;
+		snapshot.num_grid_squares_x = num_grid_squares_x;
+		snapshot.num_grid_squares_y = num_grid_squares_y;
+		snapshot.grid_square_size = grid_square_size;
+
+		return true;
+	}
+}
+
+}
@@ -0,0 +1,217 @@
+#include "heuristic_grids/wall_inflation.h"
+
+#include <algorithm>
+#include <limits.h>
+#include <math.h>
+
+namespace heuristic_grids
+{
+
+namespace
+{
+
+const double FAR = 1e20;
+
+// Squared distance transform of a sampled function in one dimension
+// (Felzenszwalb and Huttenlocher): d[q] = min over p of (q - p)^2 + f[p]
+void transform1d(const double *f, int n, double *d, int *v, double *z)
+{
+	int k = 0;
+	v[0] = 0;
+	z[0] = -FAR;
+	z[1] = FAR;
+
+	for (int q = 1; q < n; q++)
+	{
+		double s = ((f[q] + double(q) * q) - (f[v[k]] + double(v[k]) * v[k])) / (2.0 * q - 2.0 * v[k]);
+
+		while (s <= z[k])
+		{
+			k--;
+			s = ((f[q] + double(q) * q) - (f[v[k]] + double(v[k]) * v[k])) / (2.0 * q - 2.0 * v[k]);
+		}
+
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = FAR;
+	}
+
+	k = 0;
+	for (int q = 0; q < n; q++)
+	{
+		while (z[k + 1] < q)
+			k++;
+
+		d[q] = double(q - v[k]) * (q - v[k]) + f[v[k]];
+	}
+}
+
+}
+
+GridRegion::GridRegion()
+	: i_min(INT_MAX), j_min(INT_MAX), i_max(INT_MIN), j_max(INT_MIN)
+{
+}
+
+bool GridRegion::empty() const
+{
+	return i_min > i_max || j_min > j_max;
+}
+
+void GridRegion::add(int i, int j)
+{
+	i_min = std::min(i_min, i);
+	j_min = std::min(j_min, j);
+	i_max = std::max(i_max, i);
+	j_max = std::max(j_max, j);
+}
+
+void GridRegion::add(const GridRegion &other)
+{
+	if (other.empty())
+		return;
+
+	add(other.i_min, other.j_min);
+	add(other.i_max, other.j_max);
+}
+
+WallInflation::WallInflation()
+	: num_grid_squares_x(0), num_grid_squares_y(0), grid_square_size(0.02), radius_squares(0)
+{
+}
+
+void WallInflation::reset(int num_grid_squares_x, int num_grid_squares_y, float grid_square_size, int radius_squares)
+{
+	this->num_grid_squares_x = std::max(num_grid_squares_x, 0);
+	this->num_grid_squares_y = std::max(num_grid_squares_y, 0);
+	this->grid_square_size = grid_square_size;
+	this->radius_squares = std::max(radius_squares, 0);
+
+	// Points up to the radius outside the grid still inflate squares inside
+	points.reset(this->num_grid_squares_x + 2 * this->radius_squares, this->num_grid_squares_y + 2 * this->radius_squares, grid_square_size);
+	inflated_walls.reset(this->num_grid_squares_x, this->num_grid_squares_y, grid_square_size);
+}
+
+GridRegion WallInflation::addPoints(const std::vector<float> &X_wall_coordinates, const std::vector<float> &Y_wall_coordinates)
+{
+	GridRegion changed = markPoints(X_wall_coordinates, Y_wall_coordinates);
+
+	if (!changed.empty())
+		transform(changed);
+
+	return changed;
+}
+
+void WallInflation::restore(const std::vector<float> &X_wall_coordinates, const std::vector<float> &Y_wall_coordinates,
+							const Grid2D<uint8_t> &inflated_walls)
+{
+	GridRegion changed = markPoints(X_wall_coordinates, Y_wall_coordinates);
+
+	if (inflated_walls.numGridSquaresX() == num_grid_squares_x && inflated_walls.numGridSquaresY() == num_grid_squares_y)
+		this->inflated_walls = inflated_walls;
+	else if (!changed.empty())
+		transform(changed);
+}
+
+// Region whose inflation the new points may change, clipped to the grid
+GridRegion WallInflation::markPoints(const std::vector<float> &X_wall_coordinates, const std::vector<float> &Y_wall_coordinates)
+{
+	GridRegion changed;
+	size_t count = std::min(X_wall_coordinates.size(), Y_wall_coordinates.size());
+
+	for (size_t k = 0; k < count; k++)
+	{
+		int i = floor(X_wall_coordinates[k] / grid_square_size);
+		int j = floor(Y_wall_coordinates[k] / grid_square_size);
+
+		if (i < -radius_squares || j < -radius_squares || i >= num_grid_squares_x + radius_squares || j >= num_grid_squares_y + radius_squares)
+			continue;
+
+		uint8_t &point = points(i + radius_squares, j + radius_squares);
+		if (point)
+			continue;
+
+		point = 1;
+		changed.add(i - radius_squares, j - radius_squares);
+		changed.add(i + radius_squares, j + radius_squares);
+	}
+
+	changed.i_min = std::max(changed.i_min, 0);
+	changed.j_min = std::max(changed.j_min, 0);
+	changed.i_max = std::min(changed.i_max, num_grid_squares_x - 1);
+	changed.j_max = std::min(changed.j_max, num_grid_squares_y - 1);
+
+	if (changed.empty())
+		return GridRegion();
+
+	return changed;
+}
+
+// Redoes the inflation of the region. A square there is inflated by a point
+// at most radius_squares away, so the transform runs over the region grown by
+// the radius, which always lies within the padded points.
+void WallInflation::transform(const GridRegion &region)
+{
+	int i_min = region.i_min - radius_squares;
+	int j_min = region.j_min - radius_squares;
+	int i_max = region.i_max + radius_squares;
+	int j_max = region.j_max + radius_squares;
+
+	int rows = i_max - i_min + 1;
+	int cols = j_max - j_min + 1;
+	int length = std::max(rows, cols);
+
+	f.resize(length);
+	d.resize(length);
+	z.resize(length + 1);
+	v.resize(length);
+	column_distances.resize(size_t(rows) * cols);
+
+	// Along y within every row of the grown region
+	for (int i = i_min; i <= i_max; i++)
+	{
+		const uint8_t *row_points = points.row(i + radius_squares) + radius_squares;
+
+		for (int j = j_min; j <= j_max; j++)
+			f[j - j_min] = row_points[j] ? 0 : FAR;
+
+		transform1d(&f[0], cols, &column_distances[size_t(i - i_min) * cols], &v[0], &z[0]);
+	}
+
+	// Along x, only for the columns of the region itself
+	double radius_squared = double(radius_squares) * radius_squares;
+
+	for (int j = region.j_min; j <= region.j_max; j++)
+	{
+		for (int i = i_min; i <= i_max; i++)
+			f[i - i_min] = column_distances[size_t(i - i_min) * cols + j - j_min];
+
+		transform1d(&f[0], rows, &d[0], &v[0], &z[0]);
+
+		for (int i = region.i_min; i <= region.i_max; i++)
+			inflated_walls(i, j) = d[i - i_min] <= radius_squared;
+	}
+}
+
+bool WallInflation::inflated(int i, int j) const
+{
+	return inflated_walls.at(i, j, 0);
+}
+
+const Grid2D<uint8_t> &WallInflation::walls() const
+{
+	return inflated_walls;
+}
+
+int WallInflation::numGridSquaresX() const
+{
+	return num_grid_squares_x;
+}
+
+int WallInflation::numGridSquaresY() const
+{
+	return num_grid_squares_y;
+}
+
+}
@@ -0,0 +1,268 @@
+#ifndef PATH_PLANNING_GRID_ACCESS_H
+#define PATH_PLANNING_GRID_ACCESS_H
+
+#include <algorithm>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include <heuristic_grids/block_grid.h>
+#include <heuristic_grids/distance_field.h>
+#include <heuristic_grids/grid_traversal.h>
+#include <heuristic_grids/shared_grid.h>
+
+// How the planner looks up occupancy and the distance heuristic. The search
+// does not care if the answers come from the local shared memory snapshot or
+// from service calls to heuristic_grids_server.
+class GridAccess
+{
+  public:
+	virtual ~GridAccess() {}
+
+	// Called once per planning request before any lookup
+	virtual bool prepare(float x_target, float y_target) = 0;
+
+	virtual bool occupancy(float x, float y, float &value) = 0;
+
+	// Same lookup by grid square, for precomputed square offsets
+	virtual bool cellOccupancy(int i, int j, float &value)
+	{
+		return occupancy((i + 0.5) * gridSquareSize(), (j + 0.5) * gridSquareSize(), value);
+	}
+
+	// True if no square on the straight line is a wall (occupancy 1)
+	virtual bool lineOfSight(float x0, float y0, float x1, float y1)
+	{
+		return heuristic_grids::traverseGrid(x0, y0, x1, y1, gridSquareSize(), [this](int i, int j) {
+			float occupancy;
+			return !cellOccupancy(i, j, occupancy) || occupancy < 1.0;
+		});
+	}
+
+	// True if every square in [i_min, i_max] x [j_min, j_max] is known to
+	// have occupancy 0, so callers can skip looking them up
+	virtual bool regionFree(int i_min, int j_min, int i_max, int j_max)
+	{
+		return false;
+	}
+
+	// Distance in grid squares from (x, y) to the prepared target
+	virtual bool distance(float x, float y, float &value) = 0;
+
+	virtual float gridSquareSize() const = 0;
+
+	// Version of the grids the lookups answer from, 0 if not known
+	virtual uint32_t version() const
+	{
+		return 0;
+	}
+
+	// True if the squares that changed since an older version are known,
+	// cellChanged() then tells them apart
+	virtual bool changedSince(uint32_t old_version) const
+	{
+		return false;
+	}
+
+	virtual bool cellChanged(int i, int j) const
+	{
+		return true;
+	}
+};
+
+// Lookups on a local copy of the grids, the distance wavefront runs
+// in-process once per target. Keeps track of the squares that changed from
+// one version to the next, so the wavefront and the planner can repair
+// their results instead of starting over. Blocks of squares summarize the
+// copy, so lines and areas in the open are answered per block.
+class SnapshotGridAccess : public GridAccess
+{
+  public:
+	SnapshotGridAccess()
+		: changed_from(0)
+	{
+	}
+
+	void setGrid(const heuristic_grids::GridSnapshot &grid)
+	{
+		incoming = grid;
+
+		// Offline grids can share a version number, start a new wavefront
+		if (incoming.version == snapshot.version)
+		{
+			snapshot.version = 0;
+			distance_field = heuristic_grids::DistanceField();
+		}
+
+		accept();
+	}
+
+	bool prepare(float x_target, float y_target)
+	{
+		if (snapshot.empty())
+			return false;
+
+		int goal_i = snapshot.sq(x_target);
+		int goal_j = snapshot.sq(y_target);
+
+		if (distance_field.matches(snapshot, goal_i, goal_j))
+			return true;
+
+		if (changed_from != 0 && distance_field.matches(changed_from, goal_i, goal_j))
+			distance_field.update(snapshot, changed_walls);
+		else
+			distance_field.compute(snapshot, goal_i, goal_j);
+
+		return true;
+	}
+
+	bool occupancy(float x, float y, float &value)
+	{
+		value = snapshot.occupancyAt(x, y);
+		return true;
+	}
+
+	bool cellOccupancy(int i, int j, float &value)
+	{
+		value = snapshot.occupancyAtCell(i, j);
+		return true;
+	}
+
+	bool lineOfSight(float x0, float y0, float x1, float y1)
+	{
+		// Only blocks holding a wall are walked square by square
+		const heuristic_grids::GridSnapshot &grid = snapshot;
+		return heuristic_grids::traverseBlocks(blocks, x0, y0, x1, y1, 1.0, [&grid](int i, int j, float enter, float exit) {
+			return grid.occupancyAtCell(i, j) < 1.0;
+		});
+	}
+
+	bool regionFree(int i_min, int j_min, int i_max, int j_max)
+	{
+		return blocks.regionFree(i_min, j_min, i_max, j_max);
+	}
+
+	bool distance(float x, float y, float &value)
+	{
+		value = distance_field.distance(snapshot.sq(x), snapshot.sq(y));
+		return true;
+	}
+
+	float gridSquareSize() const
+	{
+		return snapshot.grid_square_size;
+	}
+
+	uint32_t version() const
+	{
+		return snapshot.version;
+	}
+
+	bool changedSince(uint32_t old_version) const
+	{
+		return old_version != 0 && old_version == changed_from;
+	}
+
+	bool cellChanged(int i, int j) const
+	{
+		// Outside the grid is always occupied
+		return snapshot.withinGrid(i, j) && changed_cells[snapshot.index(i, j)];
+	}
+
+	const heuristic_grids::GridSnapshot &grid() const
+	{
+		return snapshot;
+	}
+
+  protected:
+	// Makes `incoming` the current snapshot, noting what changed if it is
+	// the same grid at a newer version
+	void accept()
+	{
+		size_t cells = incoming.occupancy.size();
+		int i_min = incoming.num_grid_squares_x, j_min = incoming.num_grid_squares_y, i_max = -1, j_max = -1;
+
+		changed_from = 0;
+		changed_walls.clear();
+
+		if (!snapshot.empty() && incoming.num_grid_squares_x == snapshot.num_grid_squares_x && incoming.num_grid_squares_y == snapshot.num_grid_squares_y && incoming.grid_square_size == snapshot.grid_square_size)
+		{
+			changed_from = snapshot.version;
+			changed_cells.assign(cells, 0);
+
+			for (int i = 0; i < incoming.num_grid_squares_x; i++)
+			{
+				int tile = i / heuristic_grids::GRID_TILE_ROWS;
+
+				// Tiles neither grid wrote into since they were copied
+				if (incoming.occupancy.sharesTile(snapshot.occupancy, tile) && incoming.walls.sharesTile(snapshot.walls, tile))
+					continue;
+
+				const float *occupancy = incoming.occupancy.row(i), *old_occupancy = snapshot.occupancy.row(i);
+				const uint8_t *walls = incoming.walls.row(i), *old_walls = snapshot.walls.row(i);
+
+				for (int j = 0; j < incoming.num_grid_squares_y; j++)
+				{
+					size_t k = incoming.index(i, j);
+
+					if (walls[j] != old_walls[j])
+						changed_walls.push_back(k);
+
+					changed_cells[k] = occupancy[j] != old_occupancy[j] || walls[j] != old_walls[j];
+
+					if (changed_cells[k])
+					{
+						i_min = std::min(i_min, i);
+						j_min = std::min(j_min, j);
+						i_max = std::max(i_max, i);
+						j_max = std::max(j_max, j);
+					}
+				}
+			}
+		}
+
+		std::swap(snapshot, incoming);
+
+		if (changed_from == 0 || blocks.empty())
+			blocks.build(snapshot);
+		else if (i_max >= 0)
+			blocks.update(snapshot, i_min, j_min, i_max, j_max);
+	}
+
+	heuristic_grids::GridSnapshot snapshot, incoming;
+	heuristic_grids::BlockGrid blocks;
+	heuristic_grids::DistanceField distance_field;
+	uint32_t changed_from;
+	std::vector<uint8_t> changed_cells;
+	std::vector<int32_t> changed_walls;
+};
+
+// Reads the grids published by heuristic_grids_server into shared memory, so
+// no lookup leaves the planner.
+class SharedGridAccess : public SnapshotGridAccess
+{
+  public:
+	explicit SharedGridAccess(const std::string &name = heuristic_grids::DEFAULT_SHARED_GRID_NAME)
+		: reader(name)
+	{
+	}
+
+	bool prepare(float x_target, float y_target)
+	{
+		// The reader only copies if the segment holds a different version
+		incoming.version = snapshot.version;
+
+		if (!reader.read(incoming))
+			return false;
+
+		if (incoming.version != snapshot.version || snapshot.empty())
+			accept();
+
+		return SnapshotGridAccess::prepare(x_target, y_target);
+	}
+
+  private:
+	heuristic_grids::SharedGridReader reader;
+};
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef PATH_PLANNING_HYBRID_ASTAR_H
+#define PATH_PLANNING_HYBRID_ASTAR_H
+
+#include <math.h>
+#include <stdint.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "path_planning/grid_access.h"
+#include "path_planning/indexed_heap.h"
+#include "path_planning/motion_primitives.h"
+#include "path_planning/state_hash.h"
+
+// Hybrid A* search behind the path_planning service. Kept free of ROS so the
+// same search runs in offline tools.
+
+const float pi = 3.14159265358979323846;
+
+class Node;
+
+typedef std::shared_ptr<Node> node_ptr;
+
+// Node of an extracted path, with the samples of the arc leading to it
+class Node
+{
+  public:
+	std::shared_ptr<Node> parent;
+	float x, y, theta;
+	float angular_velocity;
+	float path_cost, cost_to_come, cost_to_go, path_length;
+	float angular_velocity_resolution;
+	unsigned int node_id;
+	std::vector<float> path_x, path_y, path_theta;
+
+	Node(float x, float y, float theta, float angular_velocity, std::vector<float> path_x, std::vector<float> path_y, std::vector<float> path_theta, float path_cost, float cost_to_come, unsigned int node_id);
+
+	float distanceSquared(node_ptr other_node) const
+	{
+		return pow(this->x - other_node->x, 2.0) + pow(this->y - other_node->y, 2.0);
+	}
+};
+
+// Arc a search node was reached by, besides indices into the lattice
+const int16_t PRIMITIVE_START = -1;
+const int16_t PRIMITIVE_DIRECT = -2;
+
+enum SearchNodeState
+{
+	NODE_OPEN,
+	NODE_EXPANDED,
+	// Superseded on the open list by a cheaper node of the same state
+	NODE_REPLACED,
+	// Its arc or an ancestor's crossed squares that changed
+	NODE_DEAD,
+	// Cheaper than its state, which was already expanded in this iteration.
+	// The anytime search expands it in the next one.
+	NODE_INCONSISTENT,
+	// Anytime search: expanded in an earlier iteration
+	NODE_VISITED
+};
+
+// Search state, stored in an arena that is reused between searches. The arc
+// samples are only rebuilt for the nodes of the extracted path. Costs are the
+// length driven [m] plus the occupancy penalty, the cost to go a lower bound
+// on the length still to drive.
+struct SearchNode
+{
+	float x, y, theta;
+	float path_cost, cost_to_come, cost_to_go;
+	int32_t parent;
+	int16_t primitive;
+
+	// Arc samples used, fewer than the arc has if it reached the target
+	uint8_t samples;
+	uint8_t state;
+
+	float getCost() const
+	{
+		return cost_to_come + cost_to_go;
+	}
+};
+
+struct SearchStatistics
+{
+	unsigned int expansions;
+	unsigned int successors;
+	unsigned int nodes;
+
+	// Nodes kept from the previous search for the same request
+	unsigned int reused;
+	double planning_time;
+
+	// Heuristic weight of the last finished iteration and the bound on the
+	// cost of the path found relative to the best one, 0 without a path
+	float heuristic_weight;
+	float suboptimality_bound;
+};
+
+class HybridAStar
+{
+  public:
+	HybridAStar();
+
+	// Returns the last node of the path found, follow parent to the start.
+	// NULL if the target can not be reached.
+	//
+	// Without a time limit the first path found by weighted A* is returned.
+	// With one the search is anytime (ARA*): it starts with an inflated
+	// heuristic, returns the cheapest path found when the time is up. Both
+	// report the suboptimality bound of the path in the statistics.
+	node_ptr search(GridAccess *grid_access, float x0, float y0, float theta0, float x_target, float y_target, bool exploration, double max_planning_time = 0);
+
+	const SearchStatistics &statistics() const
+	{
+		return stats;
+	}
+
+	// Nodes of the last search, valid until the next one
+	const SearchNode &searchNode(unsigned int index) const
+	{
+		return nodes[index];
+	}
+
+	unsigned int searchNodeCount() const
+	{
+		return nodes.size();
+	}
+
+	// Samples of the arc from the parent of a node of the last search
+	void nodePath(unsigned int index, std::vector<float> &path_x, std::vector<float> &path_y, std::vector<float> &path_theta) const;
+
+	// Called with the index of every node put on the open list
+	std::function<void(unsigned int)> successor_callback;
+
+	float goal_radius_tolerance;
+
+	// Heading resolution of the steering arcs, successors start from the
+	// centre of the bin of their parent
+	int primitive_heading_bins;
+
+	// Keep the search tree after a search. A new search to the same target,
+	// from within the start tolerance of the previous start, only repairs the
+	// nodes whose arcs crossed squares that changed since, if the grid access
+	// can tell which. The path returned then starts at the previous start.
+	bool incremental;
+	float start_position_tolerance, start_heading_tolerance;
+
+	// Heuristic weight of the first path, and how much the anytime search
+	// lowers it after every improved path
+	float initial_heuristic_weight;
+	float heuristic_weight_step;
+
+  private:
+	struct OpenEntry
+	{
+		float cost;
+		uint32_t node;
+	};
+
+	struct GreaterThanByCost
+	{
+		bool operator()(const OpenEntry &a, const OpenEntry &b) const
+		{
+			return a.cost > b.cost;
+		}
+	};
+
+	typedef IndexedHeap<OpenEntry, GreaterThanByCost> node_priority_queue;
+
+	float getHeuristicCost(float x, float y);
+	float priority(const SearchNode &node) const;
+	void pushOpen(uint32_t node);
+	void getSuccessorNodes(uint32_t node);
+	void getDirectTarget(uint32_t node, float x_diff, float y_diff);
+	bool targetInSight(uint32_t node_current);
+	void addStartNodes();
+	uint64_t stateKey(const SearchNode &node) const;
+	bool switchToBetterSuccessor(uint32_t node_successor);
+	node_ptr extractPath(uint32_t node_last) const;
+	bool sameRequest(float x0, float y0, float theta0, float x_target, float y_target, bool exploration) const;
+	bool arcChanged(const SearchNode &parent, const MotionPrimitive &primitive, int samples) const;
+	void repairTree();
+	bool improvePath(std::chrono::steady_clock::time_point deadline, bool anytime);
+	float suboptimalityBound(float weight) const;
+	void nextIteration();
+
+	GridAccess *grid_access;
+	std::vector<SearchNode> nodes;
+	std::vector<uint8_t> reopen_nodes;
+	node_priority_queue alive_nodes;
+
+	// Open list handle of every node in NODE_OPEN
+	std::vector<uint32_t> alive_handles;
+
+	// Node that stands for each state
+	StateTable states;
+	StateHasher state_hasher;
+	MotionPrimitiveLattice lattice;
+	SearchStatistics stats;
+
+	float x0, y0, theta0, x_target, y_target;
+	bool exploration;
+
+	// Current heuristic weight
+	float heuristic_weight;
+
+	// What the nodes in the arena were searched against
+	bool tree_valid;
+	uint32_t tree_version;
+	float tree_grid_square_size;
+	int32_t node_found, node_last_expanded;
+};
+
+#endif
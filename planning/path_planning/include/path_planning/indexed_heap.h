@@ -0,0 +1,157 @@
+#ifndef PATH_PLANNING_INDEXED_HEAP_H
+#define PATH_PLANNING_INDEXED_HEAP_H
+
+#include <stddef.h>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Binary heap that hands out a handle per pushed value, so a value still on
+// the heap can be replaced in place (decrease-key) instead of pushing a
+// duplicate. Ordered like std::priority_queue: top() is the value no other
+// value compares greater than.
+template <typename T, typename Compare = std::less<T> >
+class IndexedHeap
+{
+  public:
+	typedef size_t handle;
+
+	IndexedHeap(const Compare &compare = Compare())
+		: compare(compare)
+	{
+	}
+
+	handle push(const T &value)
+	{
+		handle h = values.size();
+		values.push_back(value);
+		positions.push_back(heap.size());
+		heap.push_back(h);
+		siftUp(heap.size() - 1);
+		return h;
+	}
+
+	const T &top() const
+	{
+		return values[heap[0]];
+	}
+
+	handle topHandle() const
+	{
+		return heap[0];
+	}
+
+	void pop()
+	{
+		positions[heap[0]] = NOT_IN_HEAP;
+
+		if (heap.size() > 1)
+		{
+			heap[0] = heap.back();
+			positions[heap[0]] = 0;
+			heap.pop_back();
+			siftDown(0);
+		}
+		else
+			heap.pop_back();
+	}
+
+	bool contains(handle h) const
+	{
+		return h < positions.size() && positions[h] != NOT_IN_HEAP;
+	}
+
+	const T &get(handle h) const
+	{
+		return values[h];
+	}
+
+	// Replaces the value behind a handle that is still on the heap
+	void update(handle h, const T &value)
+	{
+		values[h] = value;
+		siftUp(positions[h]);
+		siftDown(positions[h]);
+	}
+
+	bool empty() const
+	{
+		return heap.empty();
+	}
+
+	size_t size() const
+	{
+		return heap.size();
+	}
+
+	void reserve(size_t n)
+	{
+		values.reserve(n);
+		positions.reserve(n);
+		heap.reserve(n);
+	}
+
+	// Also drops the values of popped handles
+	void clear()
+	{
+		values.clear();
+		positions.clear();
+		heap.clear();
+	}
+
+  private:
+	static const size_t NOT_IN_HEAP = size_t(-1);
+
+	bool lower(size_t a, size_t b) const
+	{
+		return compare(values[heap[a]], values[heap[b]]);
+	}
+
+	void swap(size_t a, size_t b)
+	{
+		std::swap(heap[a], heap[b]);
+		positions[heap[a]] = a;
+		positions[heap[b]] = b;
+	}
+
+	void siftUp(size_t position)
+	{
+		while (position > 0)
+		{
+			size_t parent = (position - 1) / 2;
+
+			if (!lower(parent, position))
+				break;
+
+			swap(parent, position);
+			position = parent;
+		}
+	}
+
+	void siftDown(size_t position)
+	{
+		while (true)
+		{
+			size_t child = 2 * position + 1;
+
+			if (child >= heap.size())
+				break;
+
+			if (child + 1 < heap.size() && lower(child, child + 1))
+				child++;
+
+			if (!lower(position, child))
+				break;
+
+			swap(position, child);
+			position = child;
+		}
+	}
+
+	std::vector<T> values;
+	std::vector<size_t> positions;
+	std::vector<handle> heap;
+	Compare compare;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef PATH_PLANNING_MOTION_PRIMITIVES_H
+#define PATH_PLANNING_MOTION_PRIMITIVES_H
+
+#include <vector>
+
+// Steering arcs of the hybrid A* search, integrated once per heading bin
+// instead of on every expansion.
+
+// One integration step along an arc, relative to the start pose. Its grid
+// square depends on where the start pose is inside its own square, so it is
+// taken from the translated sample.
+struct PrimitiveSample
+{
+	float dx, dy, dtheta;
+};
+
+// Squares the samples of a heading bin's arcs can fall in, relative to the
+// square of the start pose, wherever the pose is inside that square
+struct PrimitiveReach
+{
+	int di_min, di_max, dj_min, dj_max;
+};
+
+struct MotionPrimitive
+{
+	float angular_velocity;
+	float path_length;
+	float penalty_factor;
+	std::vector<PrimitiveSample> samples;
+};
+
+class MotionPrimitiveLattice
+{
+  public:
+	MotionPrimitiveLattice();
+
+	// Rebuilds the arcs if the grid square size or heading resolution changed
+	void configure(float grid_square_size, int heading_bins);
+
+	int headingBin(float theta) const;
+
+	// Heading the arcs of a bin start from, in the same turn as theta
+	float binHeading(float theta) const;
+
+	const std::vector<MotionPrimitive> &primitives(bool exploration, int heading_bin) const
+	{
+		return lattice[exploration ? 1 : 0][heading_bin];
+	}
+
+	const PrimitiveReach &reach(bool exploration, int heading_bin) const
+	{
+		return reaches[exploration ? 1 : 0][heading_bin];
+	}
+
+	float dt;
+	float angular_velocity_resolution;
+
+  private:
+	void build(bool exploration);
+
+	float grid_square_size;
+	int heading_bins;
+	float heading_bin_size;
+
+	// [normal, exploring][heading bin]
+	std::vector<std::vector<MotionPrimitive> > lattice[2];
+	std::vector<PrimitiveReach> reaches[2];
+};
+
+#endif
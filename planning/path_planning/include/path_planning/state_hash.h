@@ -0,0 +1,154 @@
+#ifndef PATH_PLANNING_STATE_HASH_H
+#define PATH_PLANNING_STATE_HASH_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+// Discretizes a continuous (x, y, theta) search state into one grid cell and
+// heading bin, so that states the planner cannot tell apart share a key.
+class StateHasher
+{
+  public:
+	StateHasher(float cell_size = 0.02, int heading_bins = 16)
+	{
+		configure(cell_size, heading_bins);
+	}
+
+	void configure(float cell_size, int heading_bins)
+	{
+		this->cell_size = cell_size;
+		this->heading_bins = heading_bins;
+		this->heading_bin_size = 2 * M_PI / heading_bins;
+	}
+
+	int headingBin(float theta) const
+	{
+		// theta is integrated without wrapping, bring it to [0, 2 pi)
+		float wrapped = fmod(theta, 2 * M_PI);
+		if (wrapped < 0)
+			wrapped += 2 * M_PI;
+
+		int bin = int(wrapped / heading_bin_size);
+		return bin >= heading_bins ? 0 : bin;
+	}
+
+	uint64_t key(float x, float y, float theta) const
+	{
+		// 24 bits per cell index (offset so negative cells hash too), 16 for heading
+		uint64_t i = uint64_t(int64_t(floor(x / cell_size)) + (1 << 23)) & 0xFFFFFF;
+		uint64_t j = uint64_t(int64_t(floor(y / cell_size)) + (1 << 23)) & 0xFFFFFF;
+
+		return (i << 40) | (j << 16) | uint64_t(headingBin(theta));
+	}
+
+	float cellSize() const
+	{
+		return cell_size;
+	}
+
+  private:
+	float cell_size;
+	float heading_bin_size;
+	int heading_bins;
+};
+
+// No state hashes to all ones, heading bins stay far below 16 bits
+const uint64_t EMPTY_STATE_KEY = uint64_t(-1);
+
+// Open addressing table from state key to a 32 bit value. Keeps its memory
+// when cleared, so a search that fits in the previous one allocates nothing.
+class StateTable
+{
+  public:
+	static const uint32_t NONE = uint32_t(-1);
+
+	StateTable()
+		: count(0)
+	{
+		resize(10);
+	}
+
+	void clear()
+	{
+		std::fill(keys.begin(), keys.end(), EMPTY_STATE_KEY);
+		count = 0;
+	}
+
+	// NONE if the key is not in the table
+	uint32_t find(uint64_t key) const
+	{
+		size_t slot = findSlot(key);
+
+		if (keys[slot] == EMPTY_STATE_KEY)
+			return NONE;
+
+		return values[slot];
+	}
+
+	void set(uint64_t key, uint32_t value)
+	{
+		size_t slot = findSlot(key);
+
+		if (keys[slot] == EMPTY_STATE_KEY)
+		{
+			// Stay at most half full
+			if (2 * (count + 1) > keys.size())
+			{
+				resize(bits + 1);
+				slot = findSlot(key);
+			}
+
+			keys[slot] = key;
+			count++;
+		}
+
+		values[slot] = value;
+	}
+
+	size_t size() const
+	{
+		return count;
+	}
+
+  private:
+	size_t findSlot(uint64_t key) const
+	{
+		size_t mask = keys.size() - 1;
+		size_t slot = (key * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
+
+		while (keys[slot] != EMPTY_STATE_KEY && keys[slot] != key)
+			slot = (slot + 1) & mask;
+
+		return slot;
+	}
+
+	void resize(int new_bits)
+	{
+		std::vector<uint64_t> old_keys(size_t(1) << new_bits, EMPTY_STATE_KEY);
+		std::vector<uint32_t> old_values(size_t(1) << new_bits);
+
+		old_keys.swap(keys);
+		old_values.swap(values);
+		bits = new_bits;
+
+		for (size_t k = 0; k < old_keys.size(); k++)
+		{
+			if (old_keys[k] == EMPTY_STATE_KEY)
+				continue;
+
+			size_t slot = findSlot(old_keys[k]);
+			keys[slot] = old_keys[k];
+			values[slot] = old_values[k];
+		}
+	}
+
+	std::vector<uint64_t> keys;
+	std::vector<uint32_t> values;
+	size_t count;
+	int bits;
+};
+
+#endif
@@ -0,0 +1,678 @@
+#include "path_planning/hybrid_astar.h"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+
+namespace
+{
+
+// Step of the straight path to a target in sight
+const float DIRECT_DT = 0.01;
+
+float directHeading(float x_diff, float y_diff)
+{
+	return std::fmod(atan2(y_diff, x_diff) + pi, 2 * pi) - pi;
+}
+
+}
+
+Node::Node(float x, float y, float theta, float angular_velocity, std::vector<float> path_x, std::vector<float> path_y, std::vector<float> path_theta, float path_cost, float cost_to_come, unsigned int node_id)
+{
+	this->x = x;
+	this->y = y;
+	this->theta = theta;
+	this->angular_velocity = angular_velocity;
+	this->path_x = path_x;
+	this->path_y = path_y;
+	this->path_theta = path_theta;
+	this->path_cost = path_cost;
+	this->cost_to_come = cost_to_come;
+	this->cost_to_go = 0;
+
+	this->path_length = 0.3;
+
+	this->angular_velocity_resolution = pi / 2;
+
+	this->node_id = node_id;
+}
+
+HybridAStar::HybridAStar()
+	: goal_radius_tolerance(.02), primitive_heading_bins(72), incremental(true), start_position_tolerance(0.05), start_heading_tolerance(pi / 8), initial_heuristic_weight(2.5), heuristic_weight_step(0.5), grid_access(NULL), heuristic_weight(1), tree_valid(false), tree_version(0), tree_grid_square_size(0), node_found(-1), node_last_expanded(-1)
+{
+	stats.expansions = 0;
+	stats.successors = 0;
+	stats.nodes = 0;
+	stats.reused = 0;
+	stats.planning_time = 0;
+	stats.heuristic_weight = 1;
+	stats.suboptimality_bound = 1;
+}
+
+// Lower bound on the length [m] still to drive to within the goal radius.
+// A path of length L crosses at most sqrt(2) L / grid square size + 2 grid
+// lines, so the 4-connected distance in squares is at most that.
+float HybridAStar::getHeuristicCost(float x, float y)
+{
+	float squares, distance = sqrt(pow(x - x_target, 2.0) + pow(y - y_target, 2.0));
+
+	if (grid_access->distance(x, y, squares))
+		distance = std::max(distance, float((squares - 2) * grid_access->gridSquareSize() / sqrt(2.0)));
+
+	return std::max(0.0f, distance - float(sqrt(goal_radius_tolerance)));
+}
+
+float HybridAStar::priority(const SearchNode &node) const
+{
+	return node.cost_to_come + heuristic_weight * node.cost_to_go;
+}
+
+void HybridAStar::pushOpen(uint32_t node)
+{
+	OpenEntry entry = {priority(nodes[node]), node};
+
+	nodes[node].state = NODE_OPEN;
+	alive_handles.resize(nodes.size());
+	alive_handles[node] = alive_nodes.push(entry);
+}
+
+void HybridAStar::getSuccessorNodes(uint32_t node)
+{
+	// Copy, the arena may grow below
+	const SearchNode parent = nodes[node];
+	const std::vector<MotionPrimitive> &primitives = lattice.primitives(exploration, lattice.headingBin(parent.theta));
+
+	float grid_square_size = grid_access->gridSquareSize();
+	int i = floor(parent.x / grid_square_size);
+	int j = floor(parent.y / grid_square_size);
+	float theta0 = lattice.binHeading(parent.theta);
+
+	// In the open every sample has occupancy 0, no need to look them up
+	const PrimitiveReach &reach = lattice.reach(exploration, lattice.headingBin(parent.theta));
+	bool in_open = grid_access->regionFree(i + reach.di_min, j + reach.dj_min, i + reach.di_max, j + reach.dj_max);
+
+	for (size_t k = 0; k < primitives.size(); k++)
+	{
+		const MotionPrimitive &primitive = primitives[k];
+		float x = parent.x, y = parent.y, theta = parent.theta, path_cost, occupancy;
+		bool add_node = true;
+		int num_samples = primitive.samples.size();
+		int n;
+
+		path_cost = 0.0;
+
+		for (n = 0; n < num_samples; n++)
+		{
+			const PrimitiveSample &sample = primitive.samples[n];
+
+			x = parent.x + sample.dx;
+			y = parent.y + sample.dy;
+			theta = theta0 + sample.dtheta;
+
+			if (in_open)
+				occupancy = 0;
+			else if (!grid_access->cellOccupancy(floor(x / grid_square_size), floor(y / grid_square_size), occupancy) || occupancy >= 1)
+			{
+				add_node = false;
+				break;
+			}
+
+			if (pow(x - x_target, 2.0) + pow(y - y_target, 2.0) < this->goal_radius_tolerance)
+				break;
+
+			path_cost = occupancy * primitive.path_length * primitive.penalty_factor;
+		}
+
+		if (!add_node)
+			continue;
+
+		// Length driven, the occupancy cost comes on top
+		path_cost += primitive.path_length * std::min(n + 1, num_samples) / num_samples;
+
+		SearchNode successor;
+		successor.x = x;
+		successor.y = y;
+		successor.theta = theta;
+		successor.path_cost = path_cost;
+		successor.cost_to_come = parent.cost_to_come + path_cost;
+		successor.cost_to_go = getHeuristicCost(x, y);
+		successor.parent = node;
+		successor.primitive = k;
+		successor.samples = std::min(n + 1, num_samples);
+		successor.state = NODE_OPEN;
+
+		stats.successors++;
+
+		nodes.push_back(successor);
+		if (!switchToBetterSuccessor(nodes.size() - 1))
+			nodes.pop_back();
+	}
+}
+
+void HybridAStar::getDirectTarget(uint32_t node, float x_diff, float y_diff)
+{
+	const SearchNode parent = nodes[node];
+	float path_length, penalty_factor;
+
+	path_length = sqrt(pow(x_diff, 2) + pow(y_diff, 2));
+
+	float x, y, theta, path_cost, t, occupancy;
+	x = parent.x;
+	y = parent.y;
+	theta = directHeading(x_diff, y_diff);
+	penalty_factor = 0.4;
+	t = 0.0;
+
+	path_cost = 0.0;
+
+	while (t < path_length)
+	{
+		x += cos(theta) * DIRECT_DT;
+		y += sin(theta) * DIRECT_DT;
+
+		t += DIRECT_DT;
+
+		if (grid_access->occupancy(x, y, occupancy))
+			path_cost = occupancy * path_length * penalty_factor;
+	}
+
+	path_cost += path_length;
+
+	SearchNode successor;
+	successor.x = x;
+	successor.y = y;
+	successor.theta = theta;
+	successor.path_cost = path_cost;
+	successor.cost_to_come = parent.cost_to_come + path_cost;
+	successor.cost_to_go = getHeuristicCost(x, y);
+	successor.parent = node;
+	successor.primitive = PRIMITIVE_DIRECT;
+	successor.samples = 0;
+	successor.state = NODE_OPEN;
+
+	nodes.push_back(successor);
+}
+
+bool HybridAStar::targetInSight(uint32_t node_current)
+{
+	float x_diff, y_diff;
+	const SearchNode &node = nodes[node_current];
+
+	x_diff = float(x_target - node.x);
+	y_diff = float(y_target - node.y);
+
+	// Every square the straight line crosses, stops at the first wall
+	if (!grid_access->lineOfSight(node.x, node.y, x_target, y_target))
+		return false;
+
+	getDirectTarget(node_current, x_diff, y_diff);
+
+	return true;
+}
+
+void HybridAStar::addStartNodes()
+{
+	float theta0_resolution = pi / 4;
+	float cost_to_go = getHeuristicCost(x0, y0);
+
+	for (float t0 = theta0 - pi; t0 < theta0 + pi; t0 += theta0_resolution)
+	{
+		SearchNode node_start;
+		node_start.x = x0;
+		node_start.y = y0;
+		node_start.theta = t0;
+		node_start.path_cost = 0;
+		node_start.cost_to_come = 0;
+		node_start.cost_to_go = cost_to_go;
+		node_start.parent = -1;
+		node_start.primitive = PRIMITIVE_START;
+		node_start.samples = 0;
+		node_start.state = NODE_OPEN;
+
+		nodes.push_back(node_start);
+		if (!switchToBetterSuccessor(nodes.size() - 1))
+			nodes.pop_back();
+	}
+}
+
+uint64_t HybridAStar::stateKey(const SearchNode &node) const
+{
+	return state_hasher.key(node.x, node.y, node.theta);
+}
+
+bool HybridAStar::switchToBetterSuccessor(uint32_t node_successor)
+{
+	SearchNode &successor = nodes[node_successor];
+	uint64_t key = stateKey(successor);
+	uint32_t node_state = states.find(key);
+
+	// Can not lead to a cheaper path than the one found
+	if (node_found >= 0 && successor.cost_to_come >= nodes[node_found].cost_to_come)
+		return false;
+
+	if (node_state == StateTable::NONE)
+		pushOpen(node_successor);
+	else
+	{
+		SearchNode &node = nodes[node_state];
+
+		// An equivalent state is already known with a lower cost to come
+		if (successor.cost_to_come >= node.cost_to_come)
+			return false;
+
+		switch (node.state)
+		{
+		case NODE_OPEN:
+		{
+			OpenEntry entry = {priority(successor), node_successor};
+			node.state = NODE_REPLACED;
+			successor.state = NODE_OPEN;
+			alive_handles.resize(nodes.size());
+			alive_handles[node_successor] = alive_handles[node_state];
+			alive_nodes.update(alive_handles[node_successor], entry);
+			break;
+		}
+		case NODE_EXPANDED:
+			successor.state = NODE_INCONSISTENT;
+			break;
+		case NODE_INCONSISTENT:
+			node.state = NODE_REPLACED;
+			successor.state = NODE_INCONSISTENT;
+			break;
+		default:
+			pushOpen(node_successor);
+			break;
+		}
+	}
+
+	states.set(key, node_successor);
+
+	if (successor_callback)
+		successor_callback(node_successor);
+
+	return true;
+}
+
+void HybridAStar::nodePath(unsigned int index, std::vector<float> &path_x, std::vector<float> &path_y, std::vector<float> &path_theta) const
+{
+	const SearchNode &node = nodes[index];
+
+	path_x.clear();
+	path_y.clear();
+	path_theta.clear();
+
+	if (node.primitive == PRIMITIVE_START)
+	{
+		path_x.push_back(node.x);
+		path_y.push_back(node.y);
+		path_theta.push_back(node.theta);
+	}
+	else if (node.primitive == PRIMITIVE_DIRECT)
+	{
+		const SearchNode &parent = nodes[node.parent];
+		float x_diff = x_target - parent.x;
+		float y_diff = y_target - parent.y;
+		float path_length = sqrt(pow(x_diff, 2) + pow(y_diff, 2));
+		float x = parent.x, y = parent.y, theta = directHeading(x_diff, y_diff), t = 0.0;
+
+		while (t < path_length)
+		{
+			x += cos(theta) * DIRECT_DT;
+			y += sin(theta) * DIRECT_DT;
+
+			t += DIRECT_DT;
+			path_x.push_back(x);
+			path_y.push_back(y);
+			path_theta.push_back(theta);
+		}
+	}
+	else
+	{
+		const SearchNode &parent = nodes[node.parent];
+		const MotionPrimitive &primitive = lattice.primitives(exploration, lattice.headingBin(parent.theta))[node.primitive];
+		float theta0 = lattice.binHeading(parent.theta);
+
+		for (int n = 0; n < node.samples; n++)
+		{
+			path_x.push_back(parent.x + primitive.samples[n].dx);
+			path_y.push_back(parent.y + primitive.samples[n].dy);
+			path_theta.push_back(theta0 + primitive.samples[n].dtheta);
+		}
+	}
+}
+
+node_ptr HybridAStar::extractPath(uint32_t node_last) const
+{
+	node_ptr node_first, node_child;
+
+	for (int32_t index = node_last; index >= 0; index = nodes[index].parent)
+	{
+		const SearchNode &node = nodes[index];
+		std::vector<float> path_x, path_y, path_theta;
+		float angular_velocity = 0, path_length = 0.3;
+
+		nodePath(index, path_x, path_y, path_theta);
+
+		if (node.primitive >= 0)
+		{
+			const MotionPrimitive &primitive = lattice.primitives(exploration, lattice.headingBin(nodes[node.parent].theta))[node.primitive];
+			angular_velocity = primitive.angular_velocity;
+			path_length = primitive.path_length;
+		}
+
+		node_ptr path_node = std::make_shared<Node>(node.x, node.y, node.theta, angular_velocity, path_x, path_y, path_theta, node.path_cost, node.cost_to_come, index);
+		path_node->cost_to_go = node.cost_to_go;
+		path_node->path_length = path_length;
+
+		if (node_child)
+			node_child->parent = path_node;
+		else
+			node_first = path_node;
+
+		node_child = path_node;
+	}
+
+	return node_first;
+}
+
+// Same target, and a start close enough to the root of the tree that the
+// path from there still starts where the robot is
+bool HybridAStar::sameRequest(float x0, float y0, float theta0, float x_target, float y_target, bool exploration) const
+{
+	if (x_target != this->x_target || y_target != this->y_target || exploration != this->exploration)
+		return false;
+
+	float heading_diff = std::fabs(std::remainder(theta0 - this->theta0, 2 * pi));
+
+	return pow(x0 - this->x0, 2) + pow(y0 - this->y0, 2) <= pow(start_position_tolerance, 2) && heading_diff <= start_heading_tolerance;
+}
+
+bool HybridAStar::arcChanged(const SearchNode &parent, const MotionPrimitive &primitive, int samples) const
+{
+	float grid_square_size = grid_access->gridSquareSize();
+
+	// The squares the samples land in, as checked when the arc was expanded
+	for (int n = 0; n < samples; n++)
+	{
+		int i = floor((parent.x + primitive.samples[n].dx) / grid_square_size);
+		int j = floor((parent.y + primitive.samples[n].dy) / grid_square_size);
+
+		if (grid_access->cellChanged(i, j))
+			return true;
+	}
+
+	return false;
+}
+
+// Drops the nodes reached over changed squares (and their subtrees), puts
+// the expanded nodes that may now get other successors back on the open list
+// and updates every cost to go, the distance grid may have changed anywhere.
+void HybridAStar::repairTree()
+{
+	reopen_nodes.assign(nodes.size(), 0);
+
+	for (uint32_t index = 0; index < nodes.size(); index++)
+	{
+		SearchNode &node = nodes[index];
+
+		if (node.state == NODE_DEAD || node.state == NODE_REPLACED)
+			continue;
+
+		// Parents come before their children in the arena
+		if (node.primitive != PRIMITIVE_START)
+		{
+			const SearchNode &parent = nodes[node.parent];
+
+			if (parent.state == NODE_DEAD || node.primitive == PRIMITIVE_DIRECT || (reopen_nodes[node.parent] && arcChanged(parent, lattice.primitives(exploration, lattice.headingBin(parent.theta))[node.primitive], node.samples)))
+			{
+				node.state = NODE_DEAD;
+				continue;
+			}
+		}
+
+		if (node.state != NODE_EXPANDED)
+			continue;
+
+		const std::vector<MotionPrimitive> &primitives = lattice.primitives(exploration, lattice.headingBin(node.theta));
+
+		for (size_t k = 0; k < primitives.size(); k++)
+		{
+			if (arcChanged(node, primitives[k], primitives[k].samples.size()))
+			{
+				reopen_nodes[index] = 1;
+				break;
+			}
+		}
+	}
+
+	// Where the last search stopped, so the target checks run again
+	if (node_last_expanded >= 0 && nodes[node_last_expanded].state == NODE_EXPANDED)
+		reopen_nodes[node_last_expanded] = 1;
+
+	states.clear();
+	alive_nodes.clear();
+
+	for (uint32_t index = 0; index < nodes.size(); index++)
+	{
+		SearchNode &node = nodes[index];
+
+		if (node.state != NODE_OPEN && node.state != NODE_EXPANDED && node.state != NODE_INCONSISTENT)
+			continue;
+
+		stats.reused++;
+		node.cost_to_go = getHeuristicCost(node.x, node.y);
+
+		if (node.state == NODE_OPEN || reopen_nodes[index])
+			pushOpen(index);
+
+		states.set(stateKey(node), index);
+	}
+}
+
+// Expands nodes until a path is found. The anytime search goes on until no
+// open node can lead to a cheaper path under the current heuristic weight.
+// False if the deadline passed first.
+bool HybridAStar::improvePath(std::chrono::steady_clock::time_point deadline, bool anytime)
+{
+	while (!alive_nodes.empty())
+	{
+		if (anytime)
+		{
+			if (std::chrono::steady_clock::now() > deadline)
+				return false;
+
+			if (node_found >= 0 && alive_nodes.top().cost >= nodes[node_found].cost_to_come)
+				return true;
+		}
+
+		uint32_t node_current = alive_nodes.top().node;
+		alive_nodes.pop();
+		nodes[node_current].state = NODE_EXPANDED;
+		node_last_expanded = node_current;
+
+		stats.expansions++;
+
+		// Path costs never decrease along a path
+		if (node_found >= 0 && nodes[node_current].cost_to_come >= nodes[node_found].cost_to_come)
+			continue;
+
+		if (targetInSight(node_current))
+		{
+			uint32_t node_direct = nodes.size() - 1;
+
+			if (node_found < 0 || nodes[node_direct].cost_to_come < nodes[node_found].cost_to_come)
+				node_found = node_direct;
+
+			if (!anytime)
+				return true;
+			continue;
+		}
+
+		if (pow(nodes[node_current].x - x_target, 2.0) + pow(nodes[node_current].y - y_target, 2.0) < this->goal_radius_tolerance)
+		{
+			if (node_found < 0 || nodes[node_current].cost_to_come < nodes[node_found].cost_to_come)
+				node_found = node_current;
+
+			if (!anytime)
+				return true;
+			continue;
+		}
+
+		getSuccessorNodes(node_current);
+	}
+
+	return true;
+}
+
+// ARA* bound: the path found costs at most this factor more than the
+// cheapest path through the open and inconsistent nodes, and at most the
+// weight of the last finished iteration. Relative to the paths the lattice
+// can take at the resolution of the duplicate detection, infinite if the
+// open nodes give no lower bound.
+float HybridAStar::suboptimalityBound(float weight) const
+{
+	if (node_found < 0)
+		return 0;
+
+	float path_cost = nodes[node_found].cost_to_come;
+	float lowest = path_cost;
+
+	for (uint32_t index = 0; index < nodes.size(); index++)
+	{
+		const SearchNode &node = nodes[index];
+
+		if ((node.state == NODE_OPEN || node.state == NODE_INCONSISTENT) && node.primitive != PRIMITIVE_DIRECT)
+			lowest = std::min(lowest, node.getCost());
+	}
+
+	if (lowest <= 0)
+		return path_cost <= 0 ? 1 : weight;
+
+	return std::max(1.0f, std::min(weight, path_cost / lowest));
+}
+
+// Lowers the heuristic weight, moves the inconsistent nodes to the open list
+// and forgets which states were expanded
+void HybridAStar::nextIteration()
+{
+	heuristic_weight = std::max(1.0f, heuristic_weight - heuristic_weight_step);
+
+	alive_nodes.clear();
+
+	for (uint32_t index = 0; index < nodes.size(); index++)
+	{
+		SearchNode &node = nodes[index];
+
+		if (node.state == NODE_EXPANDED)
+			node.state = NODE_VISITED;
+		else if ((node.state == NODE_OPEN || node.state == NODE_INCONSISTENT) && node.primitive != PRIMITIVE_DIRECT)
+			pushOpen(index);
+	}
+}
+
+node_ptr HybridAStar::search(GridAccess *grid_access, float x0, float y0, float theta0, float x_target, float y_target, bool exploration, double max_planning_time)
+{
+	std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+	bool resume = false;
+
+	stats.expansions = 0;
+	stats.successors = 0;
+	stats.reused = 0;
+	stats.heuristic_weight = 1;
+	stats.suboptimality_bound = 1;
+
+	this->grid_access = grid_access;
+
+	bool anytime = max_planning_time > 0;
+
+	if (incremental && !anytime && tree_valid && grid_access->version() != 0 && grid_access->gridSquareSize() == tree_grid_square_size && sameRequest(x0, y0, theta0, x_target, y_target, exploration))
+	{
+		// Nothing changed since, the last answer stands
+		if (grid_access->version() == tree_version)
+		{
+			stats.reused = nodes.size();
+			stats.heuristic_weight = heuristic_weight;
+			stats.suboptimality_bound = suboptimalityBound(INFINITY);
+			node_ptr path = node_found >= 0 ? extractPath(node_found) : node_ptr();
+			stats.planning_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+			return path;
+		}
+
+		resume = grid_access->changedSince(tree_version);
+	}
+
+	// A repaired tree stays rooted at the start it was built from
+	if (!resume)
+	{
+		this->x0 = x0;
+		this->y0 = y0;
+		this->theta0 = theta0;
+	}
+	this->x_target = x_target;
+	this->y_target = y_target;
+	this->exploration = exploration;
+
+	heuristic_weight = std::max(1.0f, initial_heuristic_weight);
+	node_found = -1;
+
+	if (resume)
+		repairTree();
+	else
+	{
+		// Duplicate detection at the resolution of the heuristic grids, heading
+		// bins of pi / 8 like the node angle tolerance
+		state_hasher.configure(grid_access->gridSquareSize(), 16);
+		lattice.configure(grid_access->gridSquareSize(), primitive_heading_bins);
+
+		// Reset the arena, keeping the memory of previous searches
+		nodes.clear();
+		states.clear();
+		alive_nodes.clear();
+
+		addStartNodes();
+	}
+
+	// An anytime search leaves visited nodes behind, do not resume it
+	tree_valid = !anytime;
+	tree_version = grid_access->version();
+	tree_grid_square_size = grid_access->gridSquareSize();
+	node_last_expanded = -1;
+
+	if (!anytime)
+	{
+		// Weighted A*, stops at the first path found
+		improvePath(start_time, false);
+
+		stats.heuristic_weight = heuristic_weight;
+		stats.suboptimality_bound = suboptimalityBound(INFINITY);
+	}
+	else
+	{
+		std::chrono::steady_clock::time_point deadline = start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(max_planning_time));
+
+		float finished_weight = INFINITY;
+
+		// Each iteration improves the path with a lower heuristic weight, the
+		// last one runs plain A*
+		while (improvePath(deadline, true))
+		{
+			finished_weight = heuristic_weight;
+
+			if (heuristic_weight <= 1)
+				break;
+
+			nextIteration();
+		}
+
+		stats.heuristic_weight = std::min(finished_weight, heuristic_weight);
+		stats.suboptimality_bound = suboptimalityBound(finished_weight);
+	}
+
+	stats.nodes = nodes.size();
+
+	node_ptr path = node_found >= 0 ? extractPath(node_found) : node_ptr();
+
+	stats.planning_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+	return path;
+}
@@ -0,0 +1,122 @@
+#include "path_planning/motion_primitives.h"
+
+#include <algorithm>
+#include <math.h>
+#include "path_planning/hybrid_astar.h"
+
+MotionPrimitiveLattice::MotionPrimitiveLattice()
+	: dt(0.05), angular_velocity_resolution(pi / 2), grid_square_size(0), heading_bins(0), heading_bin_size(0)
+{
+}
+
+void MotionPrimitiveLattice::configure(float grid_square_size, int heading_bins)
+{
+	if (grid_square_size == this->grid_square_size && heading_bins == this->heading_bins)
+		return;
+
+	this->grid_square_size = grid_square_size;
+	this->heading_bins = heading_bins;
+	this->heading_bin_size = 2 * pi / heading_bins;
+
+	build(false);
+	build(true);
+}
+
+int MotionPrimitiveLattice::headingBin(float theta) const
+{
+	float wrapped = fmod(theta, 2 * pi);
+	if (wrapped < 0)
+		wrapped += 2 * pi;
+
+	int bin = int(floor(wrapped / heading_bin_size + 0.5));
+	return bin >= heading_bins ? 0 : bin;
+}
+
+float MotionPrimitiveLattice::binHeading(float theta) const
+{
+	float turn = 2 * pi * floor(theta / (2 * pi));
+	float wrapped = theta - turn;
+	float heading = floor(wrapped / heading_bin_size + 0.5) * heading_bin_size;
+
+	return turn + heading;
+}
+
+void MotionPrimitiveLattice::build(bool exploration)
+{
+	float path_length_scale, steering_angle_max;
+
+	if (exploration)
+	{
+		path_length_scale = .6;
+		steering_angle_max = pi / (8.0 * dt);
+	}
+	else
+	{
+		path_length_scale = 1.0;
+		steering_angle_max = pi / (10.0 * dt);
+	}
+
+	std::vector<std::vector<MotionPrimitive> > &bins = lattice[exploration ? 1 : 0];
+	bins.assign(heading_bins, std::vector<MotionPrimitive>());
+	reaches[exploration ? 1 : 0].assign(heading_bins, PrimitiveReach());
+
+	for (int bin = 0; bin < heading_bins; bin++)
+	{
+		float theta0 = bin * heading_bin_size;
+		PrimitiveReach &reach = reaches[exploration ? 1 : 0][bin];
+
+		reach.di_min = reach.di_max = reach.dj_min = reach.dj_max = 0;
+
+		for (float angular_velocity = -steering_angle_max; angular_velocity <= steering_angle_max; angular_velocity += angular_velocity_resolution)
+		{
+			MotionPrimitive primitive;
+			primitive.angular_velocity = angular_velocity;
+
+			if (std::abs(angular_velocity) < 1e-1)
+			{
+				primitive.penalty_factor = 0.3;
+				primitive.path_length = 0.4 * path_length_scale;
+			}
+			else if (std::abs(angular_velocity) - angular_velocity_resolution < 1e-1 || std::abs(angular_velocity) - 2 * angular_velocity_resolution < 1e-1)
+			{
+				primitive.penalty_factor = .7;
+				primitive.path_length = 0.3 * path_length_scale;
+			}
+			else
+			{
+				primitive.penalty_factor = 1.0;
+				primitive.path_length = 0.25 * path_length_scale;
+			}
+
+			float x = 0, y = 0, theta = theta0, t = 0.0;
+
+			while (t < primitive.path_length)
+			{
+				x += cos(theta) * dt;
+				y += sin(theta) * dt;
+				theta += angular_velocity * dt;
+
+				t += dt;
+
+				PrimitiveSample sample;
+				sample.dx = x;
+				sample.dy = y;
+				sample.dtheta = theta - theta0;
+
+				primitive.samples.push_back(sample);
+
+				// From the low corner of the start square the sample is in
+				// square floor(x / size), from anywhere else in it at most
+				// one further
+				int di = floor(x / grid_square_size), dj = floor(y / grid_square_size);
+
+				reach.di_min = std::min(reach.di_min, di);
+				reach.di_max = std::max(reach.di_max, di + 1);
+				reach.dj_min = std::min(reach.dj_min, dj);
+				reach.dj_max = std::max(reach.dj_max, dj + 1);
+			}
+
+			bins[bin].push_back(primitive);
+		}
+	}
+}
@@ -0,0 +1,218 @@
+// Replays the open list operations of real searches on a maze through the
+// old by-value std::priority_queue and through IndexedHeap, and reports
+// expansions per second for both.
+//
+// rosrun path_planning open_list_benchmark <maze file> [queries] [seed]
+
+#include <chrono>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <heuristic_grids/grid_builder.h>
+#include <heuristic_grids/maze_map.h>
+#include <path_planning/grid_access.h>
+#include <path_planning/hybrid_astar.h>
+
+namespace
+{
+
+const float MIN_QUERY_DISTANCE_SQUARES = 100;
+
+struct GreaterThanByCost
+{
+	bool operator()(const node_ptr a, const node_ptr b) const
+	{
+		return a->cost_to_come + a->cost_to_go > b->cost_to_come + b->cost_to_go;
+	}
+};
+
+typedef std::priority_queue<node_ptr, std::vector<node_ptr>, GreaterThanByCost> node_priority_queue;
+
+// One insert into the open list, after `pops` expansions without inserts
+struct OpenListEvent
+{
+	SearchNode search_node;
+	node_ptr node;
+	uint64_t key;
+	int pops;
+};
+
+// The old open list held shared_ptr nodes, made outside the timed replays
+void makeNodes(std::vector<OpenListEvent> &events)
+{
+	std::vector<float> path;
+
+	for (size_t k = 0; k < events.size(); k++)
+	{
+		const SearchNode &search_node = events[k].search_node;
+		events[k].node = std::make_shared<Node>(search_node.x, search_node.y, search_node.theta, 0.0f, path, path, path, search_node.path_cost, search_node.cost_to_come, k);
+		events[k].node->cost_to_go = search_node.cost_to_go;
+	}
+}
+
+// Open list entry of HybridAStar
+struct OpenEntry
+{
+	float cost;
+	uint32_t node;
+};
+
+struct GreaterThanByEntryCost
+{
+	bool operator()(const OpenEntry &a, const OpenEntry &b) const
+	{
+		return a.cost > b.cost;
+	}
+};
+
+const uint32_t EXPANDED = StateTable::NONE - 1;
+
+// What switchToBetterSuccessor used to do
+node_priority_queue pushByValue(node_ptr node, node_priority_queue alive_nodes)
+{
+	alive_nodes.push(node);
+	return alive_nodes;
+}
+
+double replayByValue(const std::vector<OpenListEvent> &events)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	node_priority_queue alive_nodes;
+
+	for (size_t k = 0; k < events.size(); k++)
+	{
+		for (int p = 0; p < events[k].pops && !alive_nodes.empty(); p++)
+			alive_nodes.pop();
+
+		alive_nodes = pushByValue(events[k].node, alive_nodes);
+	}
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double replayIndexed(const std::vector<OpenListEvent> &events)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	IndexedHeap<OpenEntry, GreaterThanByEntryCost> alive_nodes;
+	StateTable alive_handles;
+
+	for (size_t k = 0; k < events.size(); k++)
+	{
+		for (int p = 0; p < events[k].pops && !alive_nodes.empty(); p++)
+		{
+			alive_handles.set(events[alive_nodes.top().node].key, EXPANDED);
+			alive_nodes.pop();
+		}
+
+		OpenEntry entry = {events[k].search_node.getCost(), uint32_t(k)};
+		uint32_t alive_handle = alive_handles.find(events[k].key);
+
+		if (alive_handle == StateTable::NONE || alive_handle == EXPANDED)
+			alive_handles.set(events[k].key, alive_nodes.push(entry));
+		else
+			alive_nodes.update(alive_handle, entry);
+	}
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " <maze file> [queries] [seed]" << std::endl;
+		return 1;
+	}
+
+	int queries = argc > 2 ? atoi(argv[2]) : 50;
+	int seed = argc > 3 ? atoi(argv[3]) : 7;
+
+	std::vector<heuristic_grids::WallSegment> walls;
+	if (!heuristic_grids::loadMazeFile(argv[1], walls))
+	{
+		std::cerr << "Could not read " << argv[1] << std::endl;
+		return 1;
+	}
+
+	std::vector<float> X_wall_coordinates, Y_wall_coordinates;
+	heuristic_grids::discretizeWalls(walls, 0.05, X_wall_coordinates, Y_wall_coordinates);
+
+	heuristic_grids::GridSnapshot grid;
+	heuristic_grids::buildGrids(X_wall_coordinates, Y_wall_coordinates, heuristic_grids::GridParameters(), grid);
+
+	SnapshotGridAccess grid_access;
+	grid_access.setGrid(grid);
+
+	HybridAStar planner;
+	std::vector<OpenListEvent> events;
+	int32_t last_parent = -1;
+	StateHasher state_hasher(grid.grid_square_size, 16);
+
+	planner.successor_callback = [&](unsigned int index) {
+		const SearchNode &node = planner.searchNode(index);
+		OpenListEvent event = {node, node_ptr(), state_hasher.key(node.x, node.y, node.theta), 0};
+		if (node.parent != last_parent)
+		{
+			event.pops = 1;
+			last_parent = node.parent;
+		}
+		events.push_back(event);
+	};
+
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<float> x_distribution(0, grid.num_grid_squares_x * grid.grid_square_size);
+	std::uniform_real_distribution<float> y_distribution(0, grid.num_grid_squares_y * grid.grid_square_size);
+	std::uniform_real_distribution<float> theta_distribution(-pi, pi);
+
+	unsigned long expansions = 0, inserts = 0;
+	double search_time = 0, by_value_time = 0, indexed_time = 0;
+	int found = 0;
+
+	for (int query = 0; query < queries; query++)
+	{
+		float x0, y0, x_target, y_target, distance;
+
+		// Free start and goal, far apart through the distance grid so the
+		// search has to go around walls
+		do
+		{
+			x0 = x_distribution(generator);
+			y0 = y_distribution(generator);
+			x_target = x_distribution(generator);
+			y_target = y_distribution(generator);
+			grid_access.prepare(x_target, y_target);
+			grid_access.distance(x0, y0, distance);
+		} while (grid.isWall(grid.sq(x0), grid.sq(y0)) || grid.isWall(grid.sq(x_target), grid.sq(y_target)) || distance < MIN_QUERY_DISTANCE_SQUARES);
+
+		events.clear();
+		last_parent = -1;
+
+		node_ptr node_found = planner.search(&grid_access, x0, y0, theta_distribution(generator), x_target, y_target, false);
+
+		found += node_found ? 1 : 0;
+		expansions += planner.statistics().expansions;
+		inserts += events.size();
+		search_time += planner.statistics().planning_time;
+		makeNodes(events);
+		by_value_time += replayByValue(events);
+		indexed_time += replayIndexed(events);
+	}
+
+	// The search already ran with the indexed heap, swap its share for the
+	// by-value queue to estimate the old search
+	double before_time = search_time - indexed_time + by_value_time;
+
+	std::cout << "map: " << argv[1] << std::endl;
+	std::cout << "queries: " << queries << " (" << found << " found)" << std::endl;
+	std::cout << "expansions: " << expansions << ", open list inserts: " << inserts << std::endl;
+	std::cout << "open list by value: " << by_value_time << " s, indexed heap: " << indexed_time << " s" << std::endl;
+	std::cout << "expansions/s before: " << expansions / before_time << std::endl;
+	std::cout << "expansions/s after: " << expansions / search_time << std::endl;
+
+	return 0;
+}
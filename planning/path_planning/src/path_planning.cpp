@@ -6,7 +6,8 @@
 #include <vector>
 #include <iostream>
 #include <memory>
-#include <queue>
+#include <string>
+#include <unordered_map>
 #include <geometry_msgs/Twist.h>
 #include <geometry_msgs/Vector3.h>
 #include <std_msgs/Float32.h>
@@ -17,111 +18,132 @@
 #include <robo7_msgs/target_trajectory.h>
 #include <robo7_msgs/target_trajectory_point.h>
 #include "robo7_srvs/IsGridOccupied.h"
+#include "robo7_srvs/IsGridOccupiedBatch.h"
 #include "robo7_srvs/distanceTo.h"
 #include <robo7_srvs/path_planning.h>
+#include <path_planning/grid_access.h>
+#include <path_planning/hybrid_astar.h>
 
 // Service getPath
 
-class Node;
 class PathPlanning;
 
-typedef std::shared_ptr<Node> node_ptr;
-float pi = 3.14159265358979323846;
-
-float x_target;
-float y_target;
-float exploration;
-
-class Node
+// Fallback when the shared memory grids are not available, e.g. when planning
+// against a heuristic_grids_server running on another machine. Occupancy is
+// fetched a tile of squares per round trip and kept for the planning request.
+class ServiceGridAccess : public GridAccess
 {
   public:
-	std::shared_ptr<Node> parent;
-	ros::ServiceClient occupancy_client, distance_client;
+	static const int TILE_SQUARES = 16;
+
+	ros::ServiceClient occupancy_client, occupancy_batch_client, distance_client;
 	robo7_srvs::IsGridOccupied occupancy_srv;
+	robo7_srvs::IsGridOccupiedBatch occupancy_batch_srv;
 	robo7_srvs::distanceTo distance_srv;
-	float x, y, theta;
-	float angular_velocity, time, dt;
-	float path_cost, cost_to_come, cost_to_go, path_length;
-	float steering_angle_max, angular_velocity_resolution;
-	float tolerance_radius, tolerance_angle;
-	unsigned int node_id;
-	std::vector<float> path_x, path_y, path_theta;
+	double grid_square_size;
+	std::unordered_map<uint64_t, std::vector<float>> tiles;
+	bool use_tiles;
 
-	Node(float x, float y, float theta, float angular_velocity, std::vector<float> path_x, std::vector<float> path_y, std::vector<float> path_theta, float path_cost, float cost_to_come, ros::ServiceClient occupancy_client, ros::ServiceClient distance_client, unsigned int node_id)
+	void init(ros::NodeHandle nh)
 	{
-		this->x = x;
-		this->y = y;
-		this->theta = theta;
-		this->angular_velocity = angular_velocity;
-		this->path_x = path_x;
-		this->path_y = path_y;
-		this->path_theta = path_theta;
-		this->path_cost = path_cost;
-		this->cost_to_come = cost_to_come;
-
-		this->dt = 0.05;
-
-		this->path_length = 0.3;
-		if (exploration)
-			this->steering_angle_max = pi / (8.0 * this->dt);
-		else
-			this->steering_angle_max = pi / (10.0 * this->dt);
+		nh.param<double>("/heuristic_grids_server/grid_square_size", grid_square_size, 0.02);
+		use_tiles = true;
 
-		this->angular_velocity_resolution = pi / 2;
-
-		this->tolerance_radius = 3e-2;
-		this->tolerance_angle = pi / 8.0;
+		this->occupancy_client = nh.serviceClient<robo7_srvs::IsGridOccupied>("/occupancy_grid/is_occupied");
+		this->occupancy_batch_client = nh.serviceClient<robo7_srvs::IsGridOccupiedBatch>("/occupancy_grid/is_occupied_batch");
+		this->distance_client = nh.serviceClient<robo7_srvs::distanceTo>("/distance_grid/distance");
+	}
 
-		this->occupancy_client = occupancy_client;
-		this->distance_client = distance_client;
+	bool prepare(float x_target, float y_target)
+	{
+		distance_srv.request.x_to = x_target;
+		distance_srv.request.y_to = y_target;
 
-		this->node_id = node_id;
+		// The grids may have changed since the last request
+		tiles.clear();
+		use_tiles = true;
+		return true;
 	}
 
-	float getCost()
+	bool occupancy(float x, float y, float &value)
 	{
-		return cost_to_come + cost_to_go / 20;
+		return cellOccupancy(floor(x / grid_square_size), floor(y / grid_square_size), value);
 	}
 
-	float getHeuristicCost()
+	bool cellOccupancy(int i, int j, float &value)
 	{
-		this->distance_srv.request.x_from = x;
-		this->distance_srv.request.y_from = y;
-		this->distance_srv.request.x_to = x_target;
-		this->distance_srv.request.y_to = y_target;
+		int tile_i = floor(float(i) / TILE_SQUARES);
+		int tile_j = floor(float(j) / TILE_SQUARES);
+		uint64_t key = (uint64_t(uint32_t(tile_i)) << 32) | uint32_t(tile_j);
 
-		if (this->distance_client.call(this->distance_srv))
-			return this->distance_srv.response.distance;
-		else
-			return sqrt(pow(x - x_target, 2.0) + pow(y - y_target, 2.0));
+		std::unordered_map<uint64_t, std::vector<float>>::iterator tile = tiles.find(key);
+
+		if (tile == tiles.end())
+		{
+			std::vector<float> values;
+
+			// Servers without the batch service are asked square by square
+			if (!use_tiles || !fetchTile(tile_i, tile_j, values))
+			{
+				use_tiles = false;
+				return squareOccupancy(i, j, value);
+			}
+
+			tile = tiles.insert(std::make_pair(key, values)).first;
+		}
+
+		value = tile->second[(i - tile_i * TILE_SQUARES) * TILE_SQUARES + j - tile_j * TILE_SQUARES];
+		return true;
 	}
 
-	float distanceSquared(node_ptr other_node)
+	bool fetchTile(int tile_i, int tile_j, std::vector<float> &values)
 	{
-		return pow(this->x - other_node->x, 2.0) + pow(this->y - other_node->y, 2.0);
+		occupancy_batch_srv.request.x.clear();
+		occupancy_batch_srv.request.y.clear();
+
+		for (int di = 0; di < TILE_SQUARES; di++)
+		{
+			for (int dj = 0; dj < TILE_SQUARES; dj++)
+			{
+				occupancy_batch_srv.request.x.push_back((tile_i * TILE_SQUARES + di + 0.5) * grid_square_size);
+				occupancy_batch_srv.request.y.push_back((tile_j * TILE_SQUARES + dj + 0.5) * grid_square_size);
+			}
+		}
+
+		if (!occupancy_batch_client.call(occupancy_batch_srv) || occupancy_batch_srv.response.occupancies.size() != TILE_SQUARES * TILE_SQUARES)
+			return false;
+
+		values.swap(occupancy_batch_srv.response.occupancies);
+		return true;
 	}
 
-	bool inCollision()
+	bool squareOccupancy(int i, int j, float &value)
 	{
-		this->occupancy_srv.request.x = this->x;
-		this->occupancy_srv.request.y = this->y;
-		if (this->occupancy_client.call(this->occupancy_srv))
-			return this->occupancy_srv.response.occupancy >= 1;
-		else
-			return true;
+		occupancy_srv.request.x = (i + 0.5) * grid_square_size;
+		occupancy_srv.request.y = (j + 0.5) * grid_square_size;
+
+		if (!occupancy_client.call(occupancy_srv))
+			return false;
+
+		value = occupancy_srv.response.occupancy;
+		return true;
 	}
 
-	bool isClose(node_ptr other)
+	bool distance(float x, float y, float &value)
 	{
-		float position = this->distanceSquared(other);
-		float orientation = abs(theta - other->theta);
+		distance_srv.request.x_from = x;
+		distance_srv.request.y_from = y;
 
-		return position <= tolerance_radius && orientation <= tolerance_angle;
+		if (!distance_client.call(distance_srv))
+			return false;
+
+		value = distance_srv.response.distance;
+		return true;
 	}
 
-	bool is(node_ptr other)
+	float gridSquareSize() const
 	{
-		return x == other->x && y == other->y && theta == other->theta;
+		return grid_square_size;
 	}
 };
 
@@ -132,15 +154,15 @@ class PathPlanning
 	ros::ServiceServer path_service;
 	ros::Publisher paths_pub, target_pub, goal_path_pub, target_path_pub, trajectory_pub, target_trajectory_pub;
 	ros::Subscriber robot_position;
-	ros::ServiceClient occupancy_client, distance_client;
-	robo7_srvs::IsGridOccupied occupancy_srv;
-	robo7_srvs::distanceTo distance_srv;
+	ServiceGridAccess service_grid_access;
+	std::shared_ptr<SharedGridAccess> shared_grid_access;
+	GridAccess *grid_access;
+	HybridAStar planner;
 	robo7_msgs::paths paths_msg;
 
 	// Initialisation
-	float goal_radius_tolerance;
 	float x0, y0, theta0, x0_default, y0_default, theta0_default, position_updated;
-	bool path_length_scale;
+	bool use_shared_grid;
 	unsigned int node_id;
 
 	PathPlanning(ros::NodeHandle nh, ros::Publisher paths_pub, ros::Publisher target_pub, ros::Publisher target_path_pub, ros::Publisher trajectory_pub, ros::Publisher target_trajectory_pub)
@@ -154,215 +176,27 @@ class PathPlanning
 
 		path_service = nh.advertiseService("path_service", &PathPlanning::getPath, this);
 
-		this->occupancy_client = nh.serviceClient<robo7_srvs::IsGridOccupied>("/occupancy_grid/is_occupied");
-		this->distance_client = nh.serviceClient<robo7_srvs::distanceTo>("/distance_grid/distance");
-
-		goal_radius_tolerance = .02;
-		node_id = 1;
-	}
-
-	struct GreaterThanByCost
-	{
-		bool operator()(const node_ptr a, const node_ptr b) const
-		{
-			return a->getCost() > b->getCost();
-		}
-	};
-
-	typedef std::priority_queue<node_ptr, std::vector<node_ptr>, GreaterThanByCost> node_priority_queue;
-
-	float checkPathCurvature(float angular_velocity, node_ptr node)
-	{
-		float penalty_factor;
+		std::string shared_grid_name;
+		nh.param<bool>("/path_planning/use_shared_grid", use_shared_grid, true);
+		nh.param<std::string>("/path_planning/shared_grid_name", shared_grid_name, heuristic_grids::DEFAULT_SHARED_GRID_NAME);
+		nh.param<int>("/path_planning/primitive_heading_bins", planner.primitive_heading_bins, 72);
+		nh.param<bool>("/path_planning/incremental_replanning", planner.incremental, true);
+		nh.param<float>("/path_planning/start_position_tolerance", planner.start_position_tolerance, 0.05);
+		nh.param<float>("/path_planning/start_heading_tolerance", planner.start_heading_tolerance, pi / 8);
+		nh.param<float>("/path_planning/initial_heuristic_weight", planner.initial_heuristic_weight, 2.5);
+		nh.param<float>("/path_planning/heuristic_weight_step", planner.heuristic_weight_step, 0.5);
 
-		if (std::abs(angular_velocity) < 1e-1)
-		{
-			penalty_factor = 0.3;
-			node->path_length = 0.4 * this->path_length_scale;
-		}
-		else if (std::abs(angular_velocity) - node->angular_velocity_resolution < 1e-1 || std::abs(angular_velocity) - 2 * node->angular_velocity_resolution < 1e-1)
-		{
-			penalty_factor = .7;
-			node->path_length = 0.3 * this->path_length_scale;
-		}
-		else
-		{
-			penalty_factor = 1.0;
-			node->path_length = 0.25 * this->path_length_scale;
-		}
-
-		return penalty_factor;
-	}
+		service_grid_access.init(nh);
+		shared_grid_access = std::make_shared<SharedGridAccess>(shared_grid_name);
+		grid_access = &service_grid_access;
 
-	std::vector<node_ptr> getSuccessorNodes(node_ptr node, node_ptr node_target)
-	{
-		float angle_diff_tol, cost_to_come, cost;
-		std::vector<node_ptr> successors;
-		std::vector<float> path_x, path_y, path_theta;
-
-		angle_diff_tol = 1e-1;
-
-		for (float angular_velocity = -node->steering_angle_max; angular_velocity <= node->steering_angle_max; angular_velocity += node->angular_velocity_resolution)
-		{
-			float x, y, theta, path_cost, t, dt, penalty_factor;
-			bool add_node;
-			x = node->x;
-			y = node->y;
-			theta = node->theta;
-
-			t = 0.0;
-			dt = node->dt;
-
-			std::vector<float> path_x, path_y, path_theta;
-			path_cost = 0.0;
-			cost_to_come = node->cost_to_come;
-
-			penalty_factor = checkPathCurvature(angular_velocity, node);
-
-			add_node = true;
-
-			while (t < node->path_length)
-			{
-				x += cos(theta) * dt;
-				y += sin(theta) * dt;
-				theta += angular_velocity * dt;
-
-				t += dt;
-				path_x.push_back(x);
-				path_y.push_back(y);
-				path_theta.push_back(theta);
-
-				node_ptr successor_node = std::make_shared<Node>(x, y, theta, angular_velocity, path_x, path_y, path_theta, path_cost, cost_to_come, occupancy_client, distance_client, this->node_id++);
-				successor_node->cost_to_go = successor_node->getHeuristicCost();
-
-				if (successor_node->inCollision())
-				{
-					add_node = false;
-					break;
-				}
-
-				if (successor_node->distanceSquared(node_target) < this->goal_radius_tolerance)
-					break;
-
-				occupancy_srv.request.x = x;
-				occupancy_srv.request.y = y;
-
-				if (occupancy_client.call(occupancy_srv))
-					path_cost = occupancy_srv.response.occupancy * node->path_length * penalty_factor;
-				else
-				{
-					add_node = false;
-					break;
-				}
-			}
-
-			if (add_node)
-			{
-				cost_to_come += path_cost;
-				node_ptr successor_node = std::make_shared<Node>(x, y, theta, angular_velocity, path_x, path_y, path_theta, path_cost, cost_to_come, occupancy_client, distance_client, this->node_id++);
-				successor_node->cost_to_go = successor_node->getHeuristicCost();
-
-				successors.push_back(successor_node);
-			}
-		}
-
-		return successors;
-	}
-
-	node_ptr getDirectTarget(node_ptr node, float x_diff, float y_diff)
-	{
-		std::vector<float> path_x, path_y, path_theta;
-		float path_length, angular_velocity, cost_to_come, penalty_factor;
-
-		path_length = sqrt(pow(x_diff, 2) + pow(y_diff, 2));
-
-		float x, y, theta, path_cost, t, dt;
-		x = node->x;
-		y = node->y;
-		theta = std::fmod(atan2(y_diff, x_diff) + pi, 2 * pi) - pi;
-		angular_velocity = 0;
-		penalty_factor = 0.4;
-		t = 0.0;
-		dt = 0.01;
-
-		path_cost = 0.0;
-		cost_to_come = node->cost_to_come;
-
-		while (t < path_length)
-		{
-			x += cos(theta) * dt;
-			y += sin(theta) * dt;
-			theta += angular_velocity * dt;
-
-			t += dt;
-			path_x.push_back(x);
-			path_y.push_back(y);
-			path_theta.push_back(theta);
-
-			occupancy_srv.request.x = x;
-			occupancy_srv.request.y = y;
-
-			if (occupancy_client.call(occupancy_srv))
-				path_cost = occupancy_srv.response.occupancy * path_length * penalty_factor;
-		}
-
-		cost_to_come += path_cost;
-		node_ptr successor_node = std::make_shared<Node>(x, y, theta, angular_velocity, path_x, path_y, path_theta, path_cost, cost_to_come, occupancy_client, distance_client, this->node_id++);
-		successor_node->cost_to_go = successor_node->getHeuristicCost();
-
-		return successor_node;
-	}
-
-	bool targetInSight(node_ptr node_current, node_ptr node_target, robo7_srvs::path_planning::Response &res)
-	{
-		float x_diff, y_diff, x_ray, y_ray, path_length;
-
-		x_diff = float(node_target->x - node_current->x);
-		y_diff = float(node_target->y - node_current->y);
-
-		int n = floor(200 * std::max(std::abs(x_diff), std::abs(y_diff)));
-		bool visable = true;
-
-		x_ray = node_current->x;
-		y_ray = node_current->y;
-
-		for (int i_ray = 0; i_ray < n; i_ray++)
-		{
-			x_ray += x_diff / n;
-			y_ray += y_diff / n;
-
-			occupancy_srv.request.x = x_ray;
-			occupancy_srv.request.y = y_ray;
-			if (occupancy_client.call(occupancy_srv))
-			{
-				if (occupancy_srv.response.occupancy == 1.0)
-				{
-					visable = false;
-					break;
-				}
-			}
-		}
-
-		if (visable)
-		{
-			node_ptr node_successor = getDirectTarget(node_current, x_diff, y_diff);
-			node_successor->parent = node_current;
-
-			get_found_path(node_successor, node_successor, res);
-		}
-
-		return visable;
+		node_id = 1;
 	}
 
 	void initStartPosition(bool exploration, robo7_srvs::path_planning::Request &req)
 	{
 		geometry_msgs::Twist robot_position = req.robot_position;
 
-		if (exploration)
-			this->path_length_scale = .6;
-		else
-			this->path_length_scale = 1.0;
-
 		x0 = robot_position.linear.x;
 		y0 = robot_position.linear.y;
 		theta0 = robot_position.angular.z;
@@ -375,119 +209,66 @@ class PathPlanning
 		}
 	}
 
-	node_ptr getTargetNode(geometry_msgs::Point destination_position, ros::ServiceClient occupancy_client, ros::ServiceClient distance_client)
+	// Local snapshot when heuristic_grids_server shares its grids on this
+	// machine, otherwise one service call per lookup
+	void selectGridAccess(geometry_msgs::Point destination_position)
 	{
-		std::vector<float> path_x, path_y, path_theta;
-
-		x_target = destination_position.x;
-		y_target = destination_position.y;
-
-		path_x.push_back(x_target);
-		path_y.push_back(y_target);
-
-		node_ptr node_target = std::make_shared<Node>(x_target, y_target, 0.0f, 0.0f, path_x, path_y, path_theta, 0.0f, 0.0f, occupancy_client, distance_client, this->node_id++);
-		node_target->cost_to_go = 0;
-
-		return node_target;
-	}
-
-	node_priority_queue addStartNodes(node_priority_queue alive_nodes, ros::ServiceClient occupancy_client, ros::ServiceClient distance_client)
-	{
-		std::vector<float> path_x, path_y, path_theta;
-
-		float theta0_resolution = pi / 4;
-
-		for (float t0 = theta0 - pi; t0 < theta0 + pi; t0 += theta0_resolution)
+		if (use_shared_grid && shared_grid_access->prepare(destination_position.x, destination_position.y))
 		{
-			path_x.push_back(x0);
-			path_y.push_back(y0);
-			path_theta.push_back(t0);
-			node_ptr node_start = std::make_shared<Node>(x0, y0, t0, 0.0f, path_x, path_y, path_theta, 0.0f, 0.0f, occupancy_client, distance_client, this->node_id++);
-			node_start->cost_to_go = node_start->getHeuristicCost();
-
-			alive_nodes.push(node_start);
+			grid_access = shared_grid_access.get();
+			return;
 		}
 
-		return alive_nodes;
-	}
-
-	bool inDeadNodes(node_ptr node_successor, std::vector<node_ptr> dead_nodes)
-	{
-		for (int k = 0; k < dead_nodes.size(); k++)
-		{
-			node_ptr dead_node = dead_nodes[k];
+		if (use_shared_grid)
+			ROS_WARN_THROTTLE(10, "Shared heuristic grids not available, falling back to grid services");
 
-			if (node_successor->is(dead_node))
-				return true;
-		}
-		return false;
+		grid_access = &service_grid_access;
+		grid_access->prepare(destination_position.x, destination_position.y);
 	}
 
-	node_priority_queue switchToBetterSuccessor(node_ptr node_successor, node_priority_queue alive_nodes)
+	// Arcs of every node the search put on the open list, for visualization
+	void publishExploredPaths()
 	{
 		robo7_msgs::path path_msg;
-		bool match = false;
+		std::vector<float> path_theta;
+
+		paths_msg.paths.clear();
 
-		if (!match)
+		for (unsigned int i = 0; i < planner.searchNodeCount(); i++)
 		{
-			alive_nodes.push(node_successor);
-			path_msg.path_x = node_successor->path_x;
-			path_msg.path_y = node_successor->path_y;
+			if (planner.searchNode(i).primitive == PRIMITIVE_START || planner.searchNode(i).state == NODE_DEAD)
+				continue;
+
+			planner.nodePath(i, path_msg.path_x, path_msg.path_y, path_theta);
 			paths_msg.paths.push_back(path_msg);
-			paths_pub.publish(paths_msg);
 		}
-		return alive_nodes;
+
+		paths_pub.publish(paths_msg);
 	}
 
 	bool getPath(robo7_srvs::path_planning::Request &req, robo7_srvs::path_planning::Response &res)
 	{
-		std::vector<float> path_x, path_y, path_theta, goal_path_x, goal_path_y;
-		std::vector<node_ptr> successors, dead_nodes;
-		robo7_msgs::path target_path_msg;
-		geometry_msgs::Point target_msg;
-		robo7_msgs::paths target_paths_msg;
 		geometry_msgs::Point destination_position = req.destination_position;
-		node_priority_queue alive_nodes;
-
-		exploration = req.exploring;
+		geometry_msgs::Point target_msg;
+		bool exploration = req.exploring;
 
 		initStartPosition(exploration, req);
 
-		node_ptr node_target = getTargetNode(destination_position, occupancy_client, distance_client);
+		selectGridAccess(destination_position);
 
-		target_msg.x = x_target;
-		target_msg.y = y_target;
+		target_msg.x = destination_position.x;
+		target_msg.y = destination_position.y;
+		target_pub.publish(target_msg);
 
-		alive_nodes = addStartNodes(alive_nodes, occupancy_client, distance_client);
-
-		while (!alive_nodes.empty())
-		{
-			target_pub.publish(target_msg);
+		node_ptr node_found = planner.search(grid_access, x0, y0, theta0, destination_position.x, destination_position.y, exploration, req.max_planning_time);
 
-			node_ptr node_current = alive_nodes.top();
+		publishExploredPaths();
 
-			if (targetInSight(node_current, node_target, res))
-				return true;
+		res.suboptimality_bound = planner.statistics().suboptimality_bound;
+		res.planning_time = planner.statistics().planning_time;
 
-			if (node_current->distanceSquared(node_target) < this->goal_radius_tolerance)
-				return get_found_path(node_current, node_current, res);
-
-			alive_nodes.pop();
-			dead_nodes.push_back(node_current);
-
-			successors = getSuccessorNodes(node_current, node_target);
-
-			for (int i = 0; i < successors.size(); i++)
-			{
-				node_ptr node_successor = successors[i];
-				node_successor->parent = node_current;
-
-				bool in_dead_nodes = inDeadNodes(node_successor, dead_nodes);
-
-				if (!in_dead_nodes)
-					alive_nodes = switchToBetterSuccessor(node_successor, alive_nodes);
-			}
-		}
+		if (node_found)
+			return get_found_path(node_found, node_found, res);
 
 		ROS_INFO("Path not found");
 
@@ -503,7 +284,7 @@ class PathPlanning
 		node_ptr partial_node = node_current;
 		node_ptr partial_node_parent = node_current->parent;
 
-		if (partitions >= 0 && node_current->path_x.size() >= partitions + 1)
+		if (partitions >= 0 && int(node_current->path_x.size()) >= partitions + 1)
 		{
 			for (int i = partitions; i >= 0; i--)
 			{
@@ -529,8 +310,7 @@ class PathPlanning
 				float cost_to_come = partial_node->cost_to_come;
 
 				cost_to_come += path_cost;
-				partial_node_parent = std::make_shared<Node>(x, y, theta, angular_velocity, path_x, path_y, path_theta, path_cost, cost_to_come, occupancy_client, distance_client, this->node_id++);
-				partial_node_parent->cost_to_go = partial_node_parent->getHeuristicCost();
+				partial_node_parent = std::make_shared<Node>(x, y, theta, angular_velocity, path_x, path_y, path_theta, path_cost, cost_to_come, this->node_id++);
 
 				partial_node->parent = partial_node_parent;
 				partial_node = partial_node_parent;
@@ -644,7 +424,7 @@ class PathPlanning
 		node_target->path_theta.push_back(node_target->theta);
 
 		// Publish target path nodes
-		for (int i = 1; i < target_nodes.size(); i++)
+		for (size_t i = 1; i < target_nodes.size(); i++)
 		{
 			node_ptr node = target_nodes[i];
 
@@ -683,7 +463,6 @@ int main(int argc, char **argv)
 	ros::NodeHandle nh;
 	nh = ros::NodeHandle("~");
 
-	bool search_done = false;
 	double control_frequency = 10.0;
 	ros::Publisher paths_pub = nh.advertise<robo7_msgs::paths>("paths_vector", 1000);
 	ros::Publisher target_pub = nh.advertise<geometry_msgs::Point>("target", 1000);
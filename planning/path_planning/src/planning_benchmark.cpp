@@ -0,0 +1,289 @@
+// Runs a fixed set of seeded queries through the planner on every maze in a
+// directory, without a ROS master, and prints one CSV row per maze with the
+// latency, expansion and grid lookup percentiles and the mean path length.
+//
+// rosrun path_planning planning_benchmark $(rospack find ras_maze_map)/maps [queries] [seed]
+
+#include <algorithm>
+#include <chrono>
+#include <dirent.h>
+#include <iostream>
+#include <math.h>
+#include <random>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <heuristic_grids/grid_builder.h>
+#include <heuristic_grids/maze_map.h>
+#include <path_planning/grid_access.h>
+#include <path_planning/hybrid_astar.h>
+
+namespace
+{
+
+const float MIN_QUERY_DISTANCE_SQUARES = 100;
+const int MAX_QUERY_ATTEMPTS = 1000;
+
+// Counts the lookups the planner makes through another grid access
+class CountingGridAccess : public GridAccess
+{
+  public:
+	explicit CountingGridAccess(GridAccess *grid_access)
+		: grid_access(grid_access), lookups(0)
+	{
+	}
+
+	bool prepare(float x_target, float y_target)
+	{
+		return grid_access->prepare(x_target, y_target);
+	}
+
+	bool occupancy(float x, float y, float &value)
+	{
+		lookups++;
+		return grid_access->occupancy(x, y, value);
+	}
+
+	bool cellOccupancy(int i, int j, float &value)
+	{
+		lookups++;
+		return grid_access->cellOccupancy(i, j, value);
+	}
+
+	// One lookup per line or area, however many squares it covers
+	bool lineOfSight(float x0, float y0, float x1, float y1)
+	{
+		lookups++;
+		return grid_access->lineOfSight(x0, y0, x1, y1);
+	}
+
+	bool regionFree(int i_min, int j_min, int i_max, int j_max)
+	{
+		lookups++;
+		return grid_access->regionFree(i_min, j_min, i_max, j_max);
+	}
+
+	bool distance(float x, float y, float &value)
+	{
+		lookups++;
+		return grid_access->distance(x, y, value);
+	}
+
+	float gridSquareSize() const
+	{
+		return grid_access->gridSquareSize();
+	}
+
+	uint32_t version() const
+	{
+		return grid_access->version();
+	}
+
+	bool changedSince(uint32_t old_version) const
+	{
+		return grid_access->changedSince(old_version);
+	}
+
+	bool cellChanged(int i, int j) const
+	{
+		return grid_access->cellChanged(i, j);
+	}
+
+	GridAccess *grid_access;
+	unsigned long lookups;
+};
+
+struct MapResult
+{
+	std::string map;
+	int queries, found;
+	std::vector<double> latencies;
+	std::vector<double> expansions;
+	std::vector<double> lookups;
+	double path_length;
+};
+
+// Nearest rank percentile
+double percentile(std::vector<double> values, double p)
+{
+	if (values.empty())
+		return 0;
+
+	std::sort(values.begin(), values.end());
+
+	size_t rank = ceil(p / 100 * values.size());
+	return values[std::max(rank, size_t(1)) - 1];
+}
+
+double pathLength(node_ptr node)
+{
+	double length = 0;
+
+	for (; node && node->parent; node = node->parent)
+	{
+		float x = node->parent->x, y = node->parent->y;
+
+		for (size_t k = 0; k < node->path_x.size(); k++)
+		{
+			length += sqrt(pow(node->path_x[k] - x, 2) + pow(node->path_y[k] - y, 2));
+			x = node->path_x[k];
+			y = node->path_y[k];
+		}
+	}
+
+	return length;
+}
+
+std::vector<std::string> mapFiles(const std::string &directory)
+{
+	std::vector<std::string> files;
+	DIR *dir = opendir(directory.c_str());
+
+	if (dir == NULL)
+		return files;
+
+	while (struct dirent *entry = readdir(dir))
+	{
+		std::string name = entry->d_name;
+
+		if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0)
+			files.push_back(name);
+	}
+
+	closedir(dir);
+	std::sort(files.begin(), files.end());
+
+	return files;
+}
+
+// False if the file holds no walls, e.g. the object location lists
+bool benchmarkMap(const std::string &path, int queries, int seed, MapResult &result)
+{
+	std::vector<heuristic_grids::WallSegment> walls;
+	if (!heuristic_grids::loadMazeFile(path, walls) || walls.empty())
+		return false;
+
+	std::vector<float> X_wall_coordinates, Y_wall_coordinates;
+	heuristic_grids::discretizeWalls(walls, 0.05, X_wall_coordinates, Y_wall_coordinates);
+
+	heuristic_grids::GridSnapshot grid;
+	if (!heuristic_grids::buildGrids(X_wall_coordinates, Y_wall_coordinates, heuristic_grids::GridParameters(), grid))
+		return false;
+
+	SnapshotGridAccess snapshot_access;
+	snapshot_access.setGrid(grid);
+	CountingGridAccess grid_access(&snapshot_access);
+
+	HybridAStar planner;
+
+	// Same queries for a map whatever else is in the directory
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<float> x_distribution(0, grid.num_grid_squares_x * grid.grid_square_size);
+	std::uniform_real_distribution<float> y_distribution(0, grid.num_grid_squares_y * grid.grid_square_size);
+	std::uniform_real_distribution<float> theta_distribution(-pi, pi);
+
+	result.queries = 0;
+	result.found = 0;
+	result.path_length = 0;
+
+	for (int query = 0; query < queries; query++)
+	{
+		float x0, y0, x_target, y_target, distance;
+		int attempts = 0;
+
+		// Free start and goal, far apart through the distance grid so the
+		// search has to go around walls
+		do
+		{
+			distance = 0;
+			x0 = x_distribution(generator);
+			y0 = y_distribution(generator);
+			x_target = x_distribution(generator);
+			y_target = y_distribution(generator);
+
+			if (grid.isWall(grid.sq(x0), grid.sq(y0)) || grid.isWall(grid.sq(x_target), grid.sq(y_target)))
+				continue;
+
+			snapshot_access.prepare(x_target, y_target);
+			snapshot_access.distance(x0, y0, distance);
+		} while (distance < MIN_QUERY_DISTANCE_SQUARES && ++attempts < MAX_QUERY_ATTEMPTS);
+
+		if (attempts == MAX_QUERY_ATTEMPTS)
+			break;
+
+		float theta0 = theta_distribution(generator);
+
+		// Start each query on a cold distance field, like a new target
+		snapshot_access.setGrid(grid);
+		grid_access.lookups = 0;
+
+		std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+		node_ptr node_found;
+		if (grid_access.prepare(x_target, y_target))
+			node_found = planner.search(&grid_access, x0, y0, theta0, x_target, y_target, false);
+
+		double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+		result.queries++;
+		result.latencies.push_back(1000 * latency);
+		result.expansions.push_back(planner.statistics().expansions);
+		result.lookups.push_back(grid_access.lookups);
+
+		if (node_found)
+		{
+			result.found++;
+			result.path_length += pathLength(node_found);
+		}
+	}
+
+	if (result.found > 0)
+		result.path_length /= result.found;
+
+	return true;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " <maps directory> [queries] [seed]" << std::endl;
+		return 1;
+	}
+
+	std::string directory = argv[1];
+	int queries = argc > 2 ? atoi(argv[2]) : 50;
+	int seed = argc > 3 ? atoi(argv[3]) : 7;
+
+	std::vector<std::string> files = mapFiles(directory);
+
+	if (files.empty())
+	{
+		std::cerr << "No maps in " << directory << std::endl;
+		return 1;
+	}
+
+	std::cout << "map,queries,found,latency_p50_ms,latency_p95_ms,expansions_p50,expansions_p95,lookups_p50,lookups_p95,path_length_mean_m" << std::endl;
+
+	for (size_t k = 0; k < files.size(); k++)
+	{
+		MapResult result;
+		result.map = files[k];
+
+		if (!benchmarkMap(directory + "/" + files[k], queries, seed, result))
+		{
+			std::cerr << "Skipping " << files[k] << ", no walls" << std::endl;
+			continue;
+		}
+
+		std::cout << result.map << "," << result.queries << "," << result.found << ","
+				  << percentile(result.latencies, 50) << "," << percentile(result.latencies, 95) << ","
+				  << percentile(result.expansions, 50) << "," << percentile(result.expansions, 95) << ","
+				  << percentile(result.lookups, 50) << "," << percentile(result.lookups, 95) << ","
+				  << result.path_length << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,90 @@
+#ifndef SIMULATOR_DIFF_DRIVE_H
+#define SIMULATOR_DIFF_DRIVE_H
+
+#include <random>
+
+// Differential drive robot: the wheels follow the desired twist with the lag
+// of the motor controllers and turn the encoders, the pose is integrated
+// from what the wheels actually did.
+
+struct DiffDriveParameters
+{
+	// Measured values of kalman_filter
+	float wheel_radius, wheel_separation;
+	float ticks_per_revolution;
+	// Time constant of the wheel speeds following the desired ones [s]
+	float motor_time_constant;
+	// Standard deviation of the wheel speeds relative to themselves, slip
+	float wheel_slip;
+
+	DiffDriveParameters()
+		: wheel_radius(0.0488), wheel_separation(0.2173), ticks_per_revolution(897.96), motor_time_constant(0.05), wheel_slip(0)
+	{
+	}
+};
+
+class DiffDrive
+{
+  public:
+	DiffDrive();
+
+	void reset(float x, float y, float theta);
+
+	// Drives for dt [s] with the twist of /desired_velocity, converted to
+	// wheel speeds like twist_interpreter does
+	void step(float linear_velocity, float angular_velocity, double dt);
+
+	// True pose
+	float x() const
+	{
+		return pose_x;
+	}
+
+	float y() const
+	{
+		return pose_y;
+	}
+
+	float theta() const
+	{
+		return pose_theta;
+	}
+
+	// Encoder counts, forward is positive on both sides
+	long leftTicks() const;
+	long rightTicks() const;
+
+	// Distance driven by the centre of the robot [m]
+	double distance() const
+	{
+		return distance_driven;
+	}
+
+	DiffDriveParameters parameters;
+
+  private:
+	double pose_x, pose_y, pose_theta;
+	// Wheel speeds [rad/s] and angles [rad]
+	double left_speed, right_speed;
+	double left_angle, right_angle;
+	double distance_driven;
+	std::mt19937 generator;
+};
+
+// Dead reckoning of kalman_filter from the encoder counts
+class Odometry
+{
+  public:
+	Odometry();
+
+	void reset(float x, float y, float theta, long left_ticks, long right_ticks);
+	void update(long left_ticks, long right_ticks);
+
+	float x, y, theta;
+	DiffDriveParameters parameters;
+
+  private:
+	long previous_left_ticks, previous_right_ticks;
+};
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef SIMULATOR_EXPLORATION_SIMULATION_H
+#define SIMULATOR_EXPLORATION_SIMULATION_H
+
+#include <string>
+#include <vector>
+#include <exploration/exploration_map.h>
+#include <heuristic_grids/grid2d.h>
+#include <heuristic_grids/grid_builder.h>
+#include <heuristic_grids/maze_map.h>
+#include <path_follower/point_follower.h>
+#include <path_planning/grid_access.h>
+#include <path_planning/hybrid_astar.h>
+#include "simulator/diff_drive.h"
+
+// Exploration of a maze file without the robot or a ROS master. The
+// exploration (mapping_grids_server, exploration and local_exploration
+// nodes), the planner of path_planning and the control law of
+// path_follower_v2 run in-process on a simulated clock, against a
+// differential drive robot localized by its odometry. The grids are built
+// from the walls of the maze file, i.e. mapping uses ground truth: no
+// map_maintenance or localization runs on lidar scans.
+
+struct SimulationParameters
+{
+	// Start pose of kalman_filter in kinematics.launch
+	float x0, y0, theta0;
+
+	// Step of the simulated clock, the path_follower_v2 loop [s]
+	double time_step;
+	// local_exploration explores at the current pose this often [s]
+	double exploration_period;
+	// Gives up on a path, or on the whole run, after this long [s]
+	double path_timeout, max_time;
+
+	// Wall points like own_map, grids like heuristic_grids_server and
+	// mapping_grids_server
+	float discretization_step;
+	heuristic_grids::GridParameters grid;
+	float wall_thickness;
+
+	// Camera field and frontier window of mapping_grids_server
+	float camera_width, camera_height;
+	int frontier_window_size;
+
+	// Closer than this to a wall the robot touches it [m]
+	float robot_radius;
+
+	DiffDriveParameters drive;
+
+	SimulationParameters()
+		: x0(0.2), y0(0.215), theta0(1.57), time_step(0.01), exploration_period(0.5), path_timeout(60), max_time(1800),
+		  discretization_step(0.01), wall_thickness(0.01), camera_width(0.45), camera_height(0.45), frontier_window_size(4),
+		  robot_radius(0.11)
+	{
+	}
+};
+
+// CPU time spent in a part of the stack and how often it ran
+struct ComponentTime
+{
+	double cpu_time;
+	unsigned long calls;
+
+	ComponentTime()
+		: cpu_time(0), calls(0)
+	{
+	}
+};
+
+struct SimulationResult
+{
+	// Everything explored, and when on the simulated clock [s]
+	bool exploration_done;
+	double coverage_time;
+	std::string stop_reason;
+
+	// Simulated and wall clock time of the run [s]
+	double simulated_time, wall_time;
+
+	// Explored squares over the squares that are not walls
+	float coverage;
+	double distance_driven;
+
+	unsigned int planner_calls, paths_not_found, paths_timed_out;
+
+	// Closest the robot got to a wall and how many times it touched one
+	float min_clearance;
+	unsigned int contacts;
+
+	ComponentTime odometry, exploration, planning, following;
+};
+
+class ExplorationSimulation
+{
+  public:
+	ExplorationSimulation();
+
+	// Loads the walls and builds the grids, false if the file has no walls
+	bool load(const std::string &map_file);
+
+	SimulationResult run();
+
+	SimulationParameters parameters;
+
+  private:
+	void explore(SimulationResult &result);
+	bool plan(float x_target, float y_target, SimulationResult &result);
+	bool follow(SimulationResult &result);
+	void tick(SimulationResult &result);
+
+	std::vector<heuristic_grids::WallSegment> walls;
+	heuristic_grids::GridSnapshot snapshot;
+	// Inflated walls and thin walls of mapping_grids_server
+	heuristic_grids::Grid2D<float> grid, wall_grid;
+
+	ExplorationMap exploration_map;
+	SnapshotGridAccess grid_access;
+	HybridAStar planner;
+	PointFollower follower;
+	DiffDrive drive;
+	Odometry odometry;
+
+	double time, next_exploration_time;
+	bool touching;
+	std::vector<float> path_x, path_y;
+};
+
+#endif
@@ -0,0 +1,97 @@
+#include "simulator/diff_drive.h"
+
+#include <math.h>
+
+DiffDrive::DiffDrive()
+	: generator(11)
+{
+	reset(0, 0, 0);
+}
+
+void DiffDrive::reset(float x, float y, float theta)
+{
+	pose_x = x;
+	pose_y = y;
+	pose_theta = theta;
+	left_speed = 0;
+	right_speed = 0;
+	left_angle = 0;
+	right_angle = 0;
+	distance_driven = 0;
+}
+
+void DiffDrive::step(float linear_velocity, float angular_velocity, double dt)
+{
+	double desired_left = (linear_velocity - parameters.wheel_separation / 2 * angular_velocity) / parameters.wheel_radius;
+	double desired_right = (linear_velocity + parameters.wheel_separation / 2 * angular_velocity) / parameters.wheel_radius;
+
+	// First order lag, exact over the step
+	double follow = parameters.motor_time_constant > 0 ? 1 - exp(-dt / parameters.motor_time_constant) : 1;
+	left_speed += follow * (desired_left - left_speed);
+	right_speed += follow * (desired_right - right_speed);
+
+	double left_turn = left_speed * dt, right_turn = right_speed * dt;
+
+	if (parameters.wheel_slip > 0)
+	{
+		std::normal_distribution<double> slip(1, parameters.wheel_slip);
+		left_turn *= slip(generator);
+		right_turn *= slip(generator);
+	}
+
+	// The encoders count the turns, the ground sees them with slip
+	left_angle += left_speed * dt;
+	right_angle += right_speed * dt;
+
+	double linear = parameters.wheel_radius * (right_turn + left_turn) / 2;
+	double angular = parameters.wheel_radius * (right_turn - left_turn) / parameters.wheel_separation;
+
+	// Along the arc, through its middle heading
+	pose_x += linear * cos(pose_theta + angular / 2);
+	pose_y += linear * sin(pose_theta + angular / 2);
+	pose_theta += angular;
+	distance_driven += fabs(linear);
+}
+
+long DiffDrive::leftTicks() const
+{
+	return long(floor(left_angle * parameters.ticks_per_revolution / (2 * M_PI)));
+}
+
+long DiffDrive::rightTicks() const
+{
+	return long(floor(right_angle * parameters.ticks_per_revolution / (2 * M_PI)));
+}
+
+Odometry::Odometry()
+	: x(0), y(0), theta(0), previous_left_ticks(0), previous_right_ticks(0)
+{
+}
+
+void Odometry::reset(float x, float y, float theta, long left_ticks, long right_ticks)
+{
+	this->x = x;
+	this->y = y;
+	this->theta = theta;
+	previous_left_ticks = left_ticks;
+	previous_right_ticks = right_ticks;
+}
+
+void Odometry::update(long left_ticks, long right_ticks)
+{
+	float left_turn = 2 * M_PI * (left_ticks - previous_left_ticks) / parameters.ticks_per_revolution;
+	float right_turn = 2 * M_PI * (right_ticks - previous_right_ticks) / parameters.ticks_per_revolution;
+
+	previous_left_ticks = left_ticks;
+	previous_right_ticks = right_ticks;
+
+	float linear = parameters.wheel_radius * (right_turn + left_turn) / 2;
+	float angular = parameters.wheel_radius * (right_turn - left_turn) / parameters.wheel_separation;
+
+	x += linear * cos(theta);
+	y += linear * sin(theta);
+	theta += angular;
+
+	// Wrapped to [0, 2 pi) like kalman_filter
+	theta -= 2 * M_PI * floor(theta / (2 * M_PI));
+}
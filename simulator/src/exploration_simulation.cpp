@@ -0,0 +1,326 @@
+#include "simulator/exploration_simulation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <math.h>
+#include <time.h>
+#include <heuristic_grids/grid2d_mat.h>
+#include <heuristic_grids/wall_inflation.h>
+
+namespace
+{
+
+double threadCpuTime()
+{
+	timespec now;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+	return now.tv_sec + 1e-9 * now.tv_nsec;
+}
+
+// Adds the CPU time of its scope to a component
+class ScopedTimer
+{
+  public:
+	explicit ScopedTimer(ComponentTime &component)
+		: component(component), start(threadCpuTime())
+	{
+	}
+
+	~ScopedTimer()
+	{
+		component.cpu_time += threadCpuTime() - start;
+		component.calls++;
+	}
+
+  private:
+	ComponentTime &component;
+	double start;
+};
+
+float wallDistance(const std::vector<heuristic_grids::WallSegment> &walls, float x, float y)
+{
+	float distance_sq = std::numeric_limits<float>::infinity();
+
+	for (size_t k = 0; k < walls.size(); k++)
+	{
+		float ex = walls[k].x2 - walls[k].x1, ey = walls[k].y2 - walls[k].y1;
+		float length_sq = ex * ex + ey * ey;
+		float s = length_sq > 0 ? ((x - walls[k].x1) * ex + (y - walls[k].y1) * ey) / length_sq : 0;
+		s = std::min(std::max(s, 0.0f), 1.0f);
+
+		distance_sq = std::min(distance_sq, float(pow(walls[k].x1 + s * ex - x, 2) + pow(walls[k].y1 + s * ey - y, 2)));
+	}
+
+	return sqrt(distance_sq);
+}
+
+// The points path_planning sends path_follower_v2: the end of every arc,
+// which partitionPaths first splits into pieces of about 15 samples
+void trajectoryPoints(node_ptr node, std::vector<float> &path_x, std::vector<float> &path_y)
+{
+	std::vector<node_ptr> nodes;
+
+	// Not the start, it has no arc
+	for (; node && node->parent; node = node->parent)
+		nodes.push_back(node);
+
+	path_x.clear();
+	path_y.clear();
+
+	for (int k = int(nodes.size()) - 1; k >= 0; k--)
+	{
+		const std::vector<float> &arc_x = nodes[k]->path_x, &arc_y = nodes[k]->path_y;
+		int samples = arc_x.size();
+
+		if (samples == 0)
+			continue;
+
+		int partitions = std::max(samples / 15, 1);
+
+		if (samples >= partitions + 1)
+		{
+			int part_samples = samples / (partitions + 1);
+
+			for (int part = 0; part <= partitions; part++)
+			{
+				path_x.push_back(arc_x[(part + 1) * part_samples - 1]);
+				path_y.push_back(arc_y[(part + 1) * part_samples - 1]);
+			}
+		}
+
+		path_x.push_back(arc_x[samples - 1]);
+		path_y.push_back(arc_y[samples - 1]);
+	}
+}
+
+}
+
+ExplorationSimulation::ExplorationSimulation()
+	: time(0), next_exploration_time(0), touching(false)
+{
+}
+
+bool ExplorationSimulation::load(const std::string &map_file)
+{
+	if (!heuristic_grids::loadMazeFile(map_file, walls) || walls.empty())
+		return false;
+
+	std::vector<float> X_wall_coordinates, Y_wall_coordinates;
+	heuristic_grids::discretizeWalls(walls, parameters.discretization_step, X_wall_coordinates, Y_wall_coordinates);
+
+	if (!heuristic_grids::buildGrids(X_wall_coordinates, Y_wall_coordinates, parameters.grid, snapshot))
+		return false;
+
+	int num_grid_squares_x = snapshot.num_grid_squares_x;
+	int num_grid_squares_y = snapshot.num_grid_squares_y;
+	float grid_square_size = snapshot.grid_square_size;
+
+	heuristic_grids::WallInflation inflation;
+	inflation.reset(num_grid_squares_x, num_grid_squares_y, grid_square_size, ceil(parameters.wall_thickness / grid_square_size));
+	inflation.addPoints(X_wall_coordinates, Y_wall_coordinates);
+
+	grid.reset(num_grid_squares_x, num_grid_squares_y, grid_square_size);
+	wall_grid.reset(num_grid_squares_x, num_grid_squares_y, grid_square_size);
+
+	cv::Mat grid_view = heuristic_grids::matView(grid);
+	cv::Mat wall_grid_view = heuristic_grids::matView(wall_grid);
+	heuristic_grids::Grid2D<uint8_t> wall_squares;
+	snapshot.walls.copyTo(wall_squares);
+	heuristic_grids::matView(wall_squares).convertTo(grid_view, CV_32F);
+	heuristic_grids::matView(inflation.walls()).convertTo(wall_grid_view, CV_32F);
+
+	grid_access.setGrid(snapshot);
+
+	return true;
+}
+
+SimulationResult ExplorationSimulation::run()
+{
+	SimulationResult result;
+	result.exploration_done = false;
+	result.coverage_time = 0;
+	result.stop_reason = "time limit";
+	result.coverage = 0;
+	result.planner_calls = 0;
+	result.paths_not_found = 0;
+	result.paths_timed_out = 0;
+	result.min_clearance = std::numeric_limits<float>::infinity();
+	result.contacts = 0;
+
+	std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+	drive.parameters = parameters.drive;
+	odometry.parameters = parameters.drive;
+	drive.reset(parameters.x0, parameters.y0, parameters.theta0);
+	odometry.reset(parameters.x0, parameters.y0, parameters.theta0, drive.leftTicks(), drive.rightTicks());
+
+	exploration_map.configure(snapshot.grid_square_size, parameters.camera_width, parameters.camera_height, parameters.frontier_window_size);
+	exploration_map.setGrids(grid, wall_grid);
+
+	time = 0;
+	next_exploration_time = parameters.exploration_period;
+	touching = false;
+
+	// The exploration node explores where it starts, then goes from
+	// frontier to frontier
+	explore(result);
+
+	// Frontier of the last pass and when it was picked
+	float last_x = 0, last_y = 0;
+	double last_time = -1;
+
+	while (time < parameters.max_time)
+	{
+		const Frontier *frontier;
+		{
+			ScopedTimer timer(result.exploration);
+			frontier = exploration_map.cheapestFrontier();
+		}
+
+		if (frontier == NULL)
+		{
+			result.exploration_done = true;
+			result.coverage_time = time;
+			result.stop_reason = "everything explored";
+			break;
+		}
+
+		// The last pass neither drove nor explored the frontier away, the
+		// next one would do the same
+		if (time == last_time && frontier->x == last_x && frontier->y == last_y)
+		{
+			result.stop_reason = "stuck at frontier";
+			break;
+		}
+
+		last_x = frontier->x;
+		last_y = frontier->y;
+		last_time = time;
+
+		// Like the exploration node, which stops without a path
+		if (!plan(frontier->x, frontier->y, result))
+		{
+			result.paths_not_found++;
+			result.stop_reason = "no path to frontier";
+			break;
+		}
+
+		if (!follow(result))
+			result.paths_timed_out++;
+
+		// The robot explores where it arrives, also when it was already
+		// there and did not drive a step
+		explore(result);
+	}
+
+	result.simulated_time = time;
+	result.wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	result.distance_driven = drive.distance();
+
+	const heuristic_grids::Grid2D<float> &exploration_grid = exploration_map.explorationGrid();
+	int explored = 0, open = 0;
+
+	for (int i = 0; i < exploration_grid.numGridSquaresX(); i++)
+	{
+		for (int j = 0; j < exploration_grid.numGridSquaresY(); j++)
+		{
+			if (wall_grid(i, j) >= 1.0)
+				continue;
+
+			open++;
+			explored += exploration_grid(i, j) == 1.0;
+		}
+	}
+
+	result.coverage = open > 0 ? float(explored) / open : 0;
+
+	return result;
+}
+
+// mapping_grids_server's exploreHere at the pose the robot believes it is
+// at, with the occupancy heuristic_grids_server would answer
+void ExplorationSimulation::explore(SimulationResult &result)
+{
+	ScopedTimer timer(result.exploration);
+
+	const std::vector<frontier_ptr> &candidates = exploration_map.markSeen(odometry.x, odometry.y, odometry.theta);
+	std::vector<float> occupancies(candidates.size());
+
+	for (size_t k = 0; k < candidates.size(); k++)
+		occupancies[k] = snapshot.occupancyAt(candidates[k]->x, candidates[k]->y);
+
+	exploration_map.addFrontiers(occupancies);
+}
+
+bool ExplorationSimulation::plan(float x_target, float y_target, SimulationResult &result)
+{
+	ScopedTimer timer(result.planning);
+
+	result.planner_calls++;
+
+	node_ptr node_found;
+	if (grid_access.prepare(x_target, y_target))
+		node_found = planner.search(&grid_access, odometry.x, odometry.y, odometry.theta, x_target, y_target, true);
+
+	if (!node_found)
+		return false;
+
+	trajectoryPoints(node_found, path_x, path_y);
+
+	return !path_x.empty();
+}
+
+// path_follower_v2 until the end of the path. The pure rotation towards the
+// first point is left to the follower, which turns on the spot as well when
+// the point is behind.
+bool ExplorationSimulation::follow(SimulationResult &result)
+{
+	double timeout = time + parameters.path_timeout;
+
+	follower.set_path(path_x, path_y);
+
+	while (time < timeout && time < parameters.max_time)
+	{
+		float linear_velocity, angular_velocity;
+		bool path_ended;
+		{
+			ScopedTimer timer(result.following);
+			follower.point_to_follow(odometry.x, odometry.y);
+			path_ended = follower.update(odometry.x, odometry.y, odometry.theta, linear_velocity, angular_velocity);
+		}
+
+		if (path_ended)
+			return true;
+
+		{
+			ScopedTimer timer(result.odometry);
+			drive.step(linear_velocity, angular_velocity, parameters.time_step);
+			odometry.update(drive.leftTicks(), drive.rightTicks());
+		}
+
+		time += parameters.time_step;
+
+		tick(result);
+	}
+
+	return false;
+}
+
+// What runs on its own clock while the robot drives
+void ExplorationSimulation::tick(SimulationResult &result)
+{
+	float clearance = wallDistance(walls, drive.x(), drive.y());
+	result.min_clearance = std::min(result.min_clearance, clearance);
+
+	if (clearance < parameters.robot_radius && !touching)
+		result.contacts++;
+
+	touching = clearance < parameters.robot_radius;
+
+	if (time >= next_exploration_time)
+	{
+		explore(result);
+		next_exploration_time += parameters.exploration_period;
+	}
+}
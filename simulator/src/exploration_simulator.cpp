@@ -0,0 +1,77 @@
+// Explores a maze file in simulation, without the robot or a ROS master, and
+// prints how long the exploration took on the simulated clock, the CPU time
+// of every part of the stack and the number of planner calls. Mapping uses
+// the ground truth walls, so no lidar scans are simulated.
+//
+// rosrun simulator exploration_simulator $(rospack find ras_maze_map)/maps/contest_maze_2018.txt [max time s] [x0 y0 theta0]
+
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+#include "simulator/exploration_simulation.h"
+
+namespace
+{
+
+void printComponent(const std::string &name, const ComponentTime &component, double simulated_time)
+{
+	std::cout << name << "_cpu_s: " << component.cpu_time << " (" << component.calls << " calls, "
+			  << (component.calls > 0 ? 1e6 * component.cpu_time / component.calls : 0) << " us per call, "
+			  << (simulated_time > 0 ? 100 * component.cpu_time / simulated_time : 0) << " % of simulated time)" << std::endl;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " <map file> [max time s] [x0 y0 theta0]" << std::endl;
+		return 1;
+	}
+
+	ExplorationSimulation simulation;
+
+	if (argc > 2)
+		simulation.parameters.max_time = atof(argv[2]);
+
+	if (argc > 5)
+	{
+		simulation.parameters.x0 = atof(argv[3]);
+		simulation.parameters.y0 = atof(argv[4]);
+		simulation.parameters.theta0 = atof(argv[5]);
+	}
+
+	if (!simulation.load(argv[1]))
+	{
+		std::cerr << "No walls in " << argv[1] << std::endl;
+		return 1;
+	}
+
+	SimulationResult result = simulation.run();
+
+	std::cout << "map: " << argv[1] << std::endl;
+	std::cout << "stop_reason: " << result.stop_reason << std::endl;
+	std::cout << "exploration_done: " << result.exploration_done << std::endl;
+
+	if (result.exploration_done)
+		std::cout << "time_to_full_coverage_s: " << result.coverage_time << std::endl;
+
+	std::cout << "coverage: " << result.coverage << std::endl;
+	std::cout << "simulated_time_s: " << result.simulated_time << std::endl;
+	std::cout << "wall_time_s: " << result.wall_time << std::endl;
+	std::cout << "real_time_factor: " << (result.wall_time > 0 ? result.simulated_time / result.wall_time : 0) << std::endl;
+	std::cout << "distance_driven_m: " << result.distance_driven << std::endl;
+	std::cout << "planner_calls: " << result.planner_calls << std::endl;
+	std::cout << "paths_not_found: " << result.paths_not_found << std::endl;
+	std::cout << "paths_timed_out: " << result.paths_timed_out << std::endl;
+	std::cout << "min_clearance_m: " << result.min_clearance << std::endl;
+	std::cout << "wall_contacts: " << result.contacts << std::endl;
+
+	printComponent("odometry", result.odometry, result.simulated_time);
+	printComponent("exploration", result.exploration, result.simulated_time);
+	printComponent("planning", result.planning, result.simulated_time);
+	printComponent("following", result.following, result.simulated_time);
+
+	return result.exploration_done ? 0 : 2;
+}
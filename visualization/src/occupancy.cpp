@@ -6,10 +6,11 @@
 #include <cmath>
 #include <nav_msgs/GetMap.h>
 #include <nav_msgs/OccupancyGrid.h>
-#include <robo7_msgs/occupancy_matrix.h>
-#include <robo7_msgs/occupancy_row.h>
+#include "robo7_msgs/compact_grid.h"
+#include "robo7_msgs/compact_grid_delta.h"
 #include "robo7_msgs/grid_matrix.h"
 #include "robo7_msgs/grid_row.h"
+#include "heuristic_grids/grid_encoding.h"
 #include <std_msgs/Int8MultiArray.h>
 #include <algorithm>
 
@@ -18,147 +19,174 @@ float path_height = 0.0;
 class OccupancyGrid
 {
   public:
-    ros::Subscriber occupancy_grid_sub, distance_grid_sub, exploration_grid_sub;
+    ros::NodeHandle nh;
+    ros::Subscriber occupancy_grid_sub, occupancy_delta_sub, distance_grid_sub, exploration_grid_sub;
     ros::Publisher occupancy_grid_pub, distance_grid_pub, exploration_grid_pub;
-    std::vector<float> occupancy_array, distance_array, exploration_array;
-    int occupancy_grid_width, occupancy_grid_height, distance_grid_width, distance_grid_height, exploration_grid_width, exploration_grid_height;
+    nav_msgs::OccupancyGrid occupancy_grid, distance_grid;
+    uint32_t occupancy_version;
+    uint8_t occupancy_encoding;
+    float occupancy_offset, occupancy_scale;
+    std::vector<float> exploration_array;
+    int exploration_grid_width, exploration_grid_height;
     //Initialisation
 
-    bool occupancy_grid_received, distance_grid_received, exploration_grid_received;
+    bool occupancy_grid_received, exploration_grid_received;
 
     OccupancyGrid(ros::NodeHandle nh, ros::Publisher occupancy_grid_pub, ros::Publisher distance_grid_pub, ros::Publisher exploration_grid_pub)
     {
-        occupancy_grid_sub = nh.subscribe("/heuristic_grids_server/occupancy_matrix", 1000, &OccupancyGrid::occupancyCallback, this);
-        distance_grid_sub = nh.subscribe("/heuristic_grids_server/distance_matrix", 1000, &OccupancyGrid::distanceCallback, this);
+        this->nh = nh;
+        subscribeOccupancyGrid();
+        occupancy_delta_sub = nh.subscribe("/heuristic_grids_server/occupancy_grid_delta", 100, &OccupancyGrid::occupancyDeltaCallback, this);
+        distance_grid_sub = nh.subscribe("/heuristic_grids_server/distance_grid", 1, &OccupancyGrid::distanceCallback, this);
         exploration_grid_sub = nh.subscribe("/mapping_grids_server/exploration_matrix", 1000, &OccupancyGrid::explorationCallback, this);
         this->occupancy_grid_pub = occupancy_grid_pub;
         this->distance_grid_pub = distance_grid_pub;
         this->exploration_grid_pub = exploration_grid_pub;
 
         occupancy_grid_received = false;
-        distance_grid_received = false;
         exploration_grid_received = false;
     }
 
-    void occupancyCallback(const robo7_msgs::occupancy_matrix::ConstPtr &occupancy_matrix_msg)
+    // The grid is latched, so this brings the current version
+    void subscribeOccupancyGrid()
+    {
+        occupancy_grid_sub = nh.subscribe("/heuristic_grids_server/occupancy_grid", 1, &OccupancyGrid::occupancyCallback, this);
+    }
+
+    void setGridInfo(nav_msgs::OccupancyGrid &grid, const robo7_msgs::compact_grid &grid_msg)
     {
-        occupancy_array.clear();
+        grid.header.frame_id = "/map";
+        grid.header.stamp = ros::Time::now();
 
-        occupancy_grid_width = occupancy_matrix_msg->occupancy_rows.size();
-        occupancy_grid_height = occupancy_matrix_msg->occupancy_rows[0].occupancy_row.size();
+        grid.info.resolution = grid_msg.grid_square_size;
+        grid.info.width = grid_msg.num_grid_squares_x;
+        grid.info.height = grid_msg.num_grid_squares_y;
+        grid.info.origin.position.x = 0;
+        grid.info.origin.position.y = 0;
+        grid.info.origin.position.z = path_height;
 
-        for (int j = 0; j < static_cast<int>(occupancy_grid_height); j++)
+        grid.data.resize(grid.info.width * grid.info.height);
+    }
+
+    // Cell (i, j) of a compact grid in 0..1 to the 0..100 of nav_msgs
+    void setOccupancy(int i, int j, const uint8_t *cell)
+    {
+        float value = heuristic_grids::decodeCell(cell, occupancy_encoding, occupancy_offset, occupancy_scale);
+        occupancy_grid.data[j * occupancy_grid.info.width + i] = (int)(100 * value);
+    }
+
+    void occupancyCallback(const robo7_msgs::compact_grid::ConstPtr &msg)
+    {
+        setGridInfo(occupancy_grid, *msg);
+        occupancy_encoding = msg->encoding;
+        occupancy_offset = msg->offset;
+        occupancy_scale = msg->scale;
+
+        int bytes = heuristic_grids::bytesPerCell(msg->encoding);
+        if (msg->data.size() < occupancy_grid.data.size() * bytes)
+            return;
+
+        for (int i = 0; i < (int)msg->num_grid_squares_x; i++)
         {
-            for (int i = 0; i < static_cast<int>(occupancy_grid_width); i++)
+            for (int j = 0; j < (int)msg->num_grid_squares_y; j++)
             {
-              occupancy_array.push_back(occupancy_matrix_msg->occupancy_rows[i].occupancy_row[j]);
+                setOccupancy(i, j, &msg->data[(i * msg->num_grid_squares_y + j) * bytes]);
             }
         }
 
+        occupancy_version = msg->version;
         occupancy_grid_received = true;
+
+        // Only the deltas from here on, until one is missed
+        occupancy_grid_sub.shutdown();
+
+        occupancy_grid_pub.publish(occupancy_grid);
     }
 
-    void distanceCallback(const robo7_msgs::occupancy_matrix::ConstPtr &distance_matrix_msg)
+    void occupancyDeltaCallback(const robo7_msgs::compact_grid_delta::ConstPtr &msg)
     {
-        distance_array.clear();
-        distance_grid_width = distance_matrix_msg->occupancy_rows.size();
-        if(distance_grid_width > 0)
-        {
-          distance_grid_height = distance_matrix_msg->occupancy_rows[0].occupancy_row.size();
-        }
-        else
+        if (!occupancy_grid_received)
+            return;
+
+        if (msg->base_version != occupancy_version)
         {
-          distance_grid_height = 0;
+            // Unless it is older than our grid, one was missed and the
+            // latched grid has the current version
+            if (msg->version > occupancy_version && !occupancy_grid_sub)
+                subscribeOccupancyGrid();
+            return;
         }
 
-        for (int j = 0; j < distance_grid_height; j++)
+        int bytes = heuristic_grids::bytesPerCell(occupancy_encoding);
+
+        for (size_t k = 0; k < msg->regions.size(); k++)
         {
-            for (int i = 0; i < distance_grid_width; i++)
+            const robo7_msgs::compact_grid_region &region = msg->regions[k];
+
+            if (region.i_min + region.num_grid_squares_x > occupancy_grid.info.width ||
+                region.j_min + region.num_grid_squares_y > occupancy_grid.info.height ||
+                region.data.size() < region.num_grid_squares_x * region.num_grid_squares_y * bytes)
+                continue;
+
+            for (int i = 0; i < (int)region.num_grid_squares_x; i++)
             {
-                distance_array.push_back(distance_matrix_msg->occupancy_rows[i].occupancy_row[j]);
+                for (int j = 0; j < (int)region.num_grid_squares_y; j++)
+                {
+                    setOccupancy(region.i_min + i, region.j_min + j, &region.data[(i * region.num_grid_squares_y + j) * bytes]);
+                }
             }
         }
 
-        distance_grid_received = true;
+        occupancy_version = msg->version;
+        occupancy_grid.header.stamp = ros::Time::now();
+        occupancy_grid_pub.publish(occupancy_grid);
     }
 
-    void explorationCallback(const robo7_msgs::grid_matrix::ConstPtr &exploration_matrix_msg)
+    void distanceCallback(const robo7_msgs::compact_grid::ConstPtr &msg)
     {
-        exploration_array.clear();
+        setGridInfo(distance_grid, *msg);
 
-        exploration_grid_width = exploration_matrix_msg->grid_rows.size();
-        exploration_grid_height = exploration_matrix_msg->grid_rows[0].grid_row.size();
+        int bytes = heuristic_grids::bytesPerCell(msg->encoding);
+        if (msg->data.size() < distance_grid.data.size() * bytes)
+            return;
 
-        for (int j = 0; j < exploration_grid_height; j++)
+        std::vector<float> distance_array(distance_grid.data.size());
+        for (int i = 0; i < (int)msg->num_grid_squares_x; i++)
         {
-            for (int i = 0; i < exploration_grid_width; i++)
+            for (int j = 0; j < (int)msg->num_grid_squares_y; j++)
             {
-                exploration_array.push_back(exploration_matrix_msg->grid_rows[i].grid_row[j]);
+                distance_array[j * msg->num_grid_squares_x + i] = heuristic_grids::decodeCell(&msg->data[(i * msg->num_grid_squares_y + j) * bytes], msg->encoding, msg->offset, msg->scale);
             }
         }
 
-        exploration_grid_received = true;
-    }
-
-    void updateOccupancyGrid()
-    {
-
-        if (this->occupancy_grid_received)
+        float max_distance = distance_array.empty() ? 0 : *max_element(distance_array.begin(), distance_array.end());
+        for (size_t k = 0; k < distance_array.size(); k++)
         {
-            nav_msgs::OccupancyGrid occupancy_grid;
-
-            occupancy_grid.header.frame_id = "/map";
-            occupancy_grid.header.stamp = ros::Time::now();
-
-            occupancy_grid.info.resolution = 2.44 / occupancy_grid_width;
-            occupancy_grid.info.width = occupancy_grid_width;
-            occupancy_grid.info.height = occupancy_grid_height;
-            occupancy_grid.info.origin.position.x = 0;
-            occupancy_grid.info.origin.position.y = 0;
-            occupancy_grid.info.origin.position.z = path_height;
-
-            for (int i = 0; i < occupancy_grid_width * occupancy_grid_height; i++)
-            {
-                int grid_value = (int)100 * occupancy_array[i];
-                occupancy_grid.data.push_back(grid_value);
-            }
-            occupancy_grid_pub.publish(occupancy_grid);
+            if (distance_array[k] == 0 || max_distance == 0)
+                distance_grid.data[k] = 100;
+            else
+                distance_grid.data[k] = (int)(100 * distance_array[k] / max_distance);
         }
+
+        distance_grid_pub.publish(distance_grid);
     }
 
-    void updateDistanceGrid()
+    void explorationCallback(const robo7_msgs::grid_matrix::ConstPtr &exploration_matrix_msg)
     {
+        exploration_array.clear();
 
-        if (this->distance_grid_received)
-        {
-            int grid_value;
-            nav_msgs::OccupancyGrid distance_grid;
-
-            distance_grid.header.frame_id = "/map";
-            distance_grid.header.stamp = ros::Time::now();
-
-            distance_grid.info.resolution = 2.44 / distance_grid_width;
-            distance_grid.info.width = distance_grid_width;
-            distance_grid.info.height = distance_grid_height;
-            distance_grid.info.origin.position.x = 0;
-            distance_grid.info.origin.position.y = 0;
-            distance_grid.info.origin.position.z = path_height;
+        exploration_grid_width = exploration_matrix_msg->grid_rows.size();
+        exploration_grid_height = exploration_matrix_msg->grid_rows[0].grid_row.size();
 
-            float max_distance = *max_element(distance_array.begin(), distance_array.end());
-            for (int i = 0; i < distance_grid_width * distance_grid_height; i++)
+        for (int j = 0; j < exploration_grid_height; j++)
+        {
+            for (int i = 0; i < exploration_grid_width; i++)
             {
-                if (distance_array[i] == 0)
-                {
-                    grid_value = 100;
-                }
-                else
-                    grid_value = (int)100 * distance_array[i] / max_distance;
-
-                distance_grid.data.push_back(grid_value);
+                exploration_array.push_back(exploration_matrix_msg->grid_rows[i].grid_row[j]);
             }
-
-            distance_grid_pub.publish(distance_grid);
         }
+
+        exploration_grid_received = true;
     }
 
     void updateExplorationGrid()
@@ -198,19 +226,18 @@ int main(int argc, char **argv)
     ros::init(argc, argv, "occupancy");
     ros::NodeHandle nh;
 
-    ros::Publisher occupancy_grid_pub = nh.advertise<nav_msgs::OccupancyGrid>("OccupancyGrid/Occupancy_Grid", 100);
-    ros::Publisher distance_grid_pub = nh.advertise<nav_msgs::OccupancyGrid>("OccupancyGrid/Distance_Grid", 100);
+    // Only published when the grids change, so latched for late subscribers
+    ros::Publisher occupancy_grid_pub = nh.advertise<nav_msgs::OccupancyGrid>("OccupancyGrid/Occupancy_Grid", 100, true);
+    ros::Publisher distance_grid_pub = nh.advertise<nav_msgs::OccupancyGrid>("OccupancyGrid/Distance_Grid", 100, true);
     ros::Publisher exploration_grid_pub = nh.advertise<nav_msgs::OccupancyGrid>("OccupancyGrid/Exploration_Grid", 100);
 
     ROS_INFO("Init Grid Visualization");
-    OccupancyGrid occupancy_grid = OccupancyGrid(nh, occupancy_grid_pub, distance_grid_pub, exploration_grid_pub);
+    OccupancyGrid occupancy_grid(nh, occupancy_grid_pub, distance_grid_pub, exploration_grid_pub);
 
     ros::Rate loop_rate(100);
 
     while (ros::ok())
     {
-        occupancy_grid.updateOccupancyGrid();
-        occupancy_grid.updateDistanceGrid();
         occupancy_grid.updateExplorationGrid();
 
         ros::spinOnce();